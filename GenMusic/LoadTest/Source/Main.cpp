@@ -0,0 +1,245 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 19 Oct 2026 10:18:41am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <fmt/core.h>
+#include <sys/resource.h>
+#include "../../Source/Utilities.h"
+#include "../../Source/RenderSettings.h"
+#include "../../Source/RenderEngine.h"
+#include "../../Source/DSPKernels.h"
+#include "../../Source/AudioBufferPool.h"
+
+// Renders a corpus of seeds end to end, seed to wav and midi on disk, on a number of threads at once with synthetic
+// samples, and prints one JSON object describing how it went so runs from different builds can be diffed.
+// usage: GenMusicLoadTest [--songs=count] [--seeds=file] [--concurrency=threads] [--warmup=songs] [--preview]
+//                         [--compact-samples] [--repitch-cache-mb=size] [--note-cache-mb=size] [--sample-rate=rate]
+//                         [--convolution-reverb] [--output=file]
+// --seeds is one seed per line and overrides --songs, --warmup songs are rendered by every thread before the clock
+// starts so the repitch and note caches are as warm as a long running daemon's. --convolution-reverb swaps the aux
+// return's algorithmic reverb for a convolution with a generated impulse response
+
+struct SongResult {
+    RenderTimings timings;
+    // wall clock from asking for the song to it being on disk
+    double latencyMs = 0.0;
+};
+
+static double getPeakResidentMegabytes() {
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+#if JUCE_MAC
+    // bytes on macOS, kilobytes everywhere else
+    return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+    return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+static juce::var percentiles(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    auto percentile = [&values](double fraction) {
+        return values[std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()))];
+    };
+
+    auto* object = new juce::DynamicObject();
+    object->setProperty("p50", percentile(0.5));
+    object->setProperty("p95", percentile(0.95));
+    object->setProperty("p99", percentile(0.99));
+    object->setProperty("max", values.back());
+    return juce::var(object);
+}
+
+static juce::var cacheReport(const RepitchCacheStats& stats) {
+    auto* object = new juce::DynamicObject();
+    object->setProperty("hits", stats.hits);
+    object->setProperty("misses", stats.misses);
+    object->setProperty("evictions", stats.evictions);
+    object->setProperty("resident_notes", stats.residentNotes);
+    object->setProperty("resident_mb", stats.residentBytes / (1024.0 * 1024.0));
+    return juce::var(object);
+}
+
+int main(int argc, char *argv[]) {
+    juce::ArgumentList args(argc, argv);
+    const auto workingDirectory = juce::File::getCurrentWorkingDirectory();
+    // the render chatter would end up in the middle of the report
+    verboseLogging = false;
+
+    auto settings = args.containsOption("--preview") ? RenderSettings::forPreview() : RenderSettings::forFinal();
+    if (args.containsOption("--sample-rate")) {
+        settings.sampleRate = args.getValueForOption("--sample-rate").getDoubleValue();
+    }
+    settings.useSyntheticSamples = true;
+    settings.compactSampleStorage = args.containsOption("--compact-samples");
+    if (args.containsOption("--repitch-cache-mb")) {
+        settings.repitchCacheBudgetBytes = static_cast<std::size_t>(args.getValueForOption("--repitch-cache-mb").getLargeIntValue()) * 1024 * 1024;
+    }
+    if (args.containsOption("--note-cache-mb")) {
+        settings.noteCacheBudgetBytes = static_cast<std::size_t>(args.getValueForOption("--note-cache-mb").getLargeIntValue()) * 1024 * 1024;
+    }
+    if (args.containsOption("--convolution-reverb")) {
+        // synthetic renders generate the response, there's no file to read
+        settings.impulseResponsePath = "synthetic";
+    }
+
+    std::vector<std::string> seeds;
+    if (args.containsOption("--seeds")) {
+        juce::StringArray lines;
+        workingDirectory.getChildFile(args.getValueForOption("--seeds")).readLines(lines);
+        lines.trim();
+        lines.removeEmptyStrings();
+        for (const auto& line : lines) {
+            seeds.push_back(line.toStdString());
+        }
+    } else {
+        const auto songs = args.containsOption("--songs") ? args.getValueForOption("--songs").getIntValue() : 32;
+        for (int i = 0; i < songs; ++i) {
+            seeds.push_back(fmt::format("load test {}", i));
+        }
+    }
+    const auto concurrency = std::max(1, args.containsOption("--concurrency") ? args.getValueForOption("--concurrency").getIntValue() : juce::SystemStats::getNumCpus());
+    const auto warmup = std::max(0, args.getValueForOption("--warmup").getIntValue());
+    if (seeds.empty()) {
+        fmt::println(stderr, "no seeds to render");
+        return 1;
+    }
+
+    // every song is written for real, then thrown away with the rest of the directory
+    const auto outputDirectory = juce::File::createTempFile("genmusic-load-test");
+    outputDirectory.createDirectory();
+    const juce::ScopeGuard removeOutput { [&] { outputDirectory.deleteRecursively(); } };
+
+    std::vector<SongResult> results(seeds.size());
+    std::atomic<size_t> nextSeed { 0 };
+    std::atomic<int> readyWorkers { 0 };
+    std::atomic<bool> failed { false };
+    std::vector<double> setupMs(static_cast<size_t>(concurrency));
+    std::vector<RepitchCacheStats> cacheStats(static_cast<size_t>(concurrency));
+    std::vector<RepitchCacheStats> noteCacheStats(static_cast<size_t>(concurrency));
+    juce::WaitableEvent startRendering(true);
+    double startTime = 0.0;
+
+    // each worker has its own engine, an engine only renders one song at a time
+    auto work = [&](int worker) {
+        try {
+            const auto setupStart = juce::Time::getMillisecondCounterHiRes();
+            RenderEngine engine(settings);
+            for (int i = 0; i < warmup; ++i) {
+                engine.render(fmt::format("warm up {} {}", worker, i), outputDirectory.getChildFile(fmt::format("warmup-{}.wav", worker)), outputDirectory.getChildFile(fmt::format("warmup-{}.mid", worker)));
+            }
+            setupMs[static_cast<size_t>(worker)] = juce::Time::getMillisecondCounterHiRes() - setupStart;
+
+            if (++readyWorkers == concurrency) {
+                startTime = juce::Time::getMillisecondCounterHiRes();
+                startRendering.signal();
+            }
+            startRendering.wait();
+
+            for (auto index = nextSeed++; index < seeds.size() && !failed; index = nextSeed++) {
+                const auto songStart = juce::Time::getMillisecondCounterHiRes();
+                const auto name = fmt::format("song-{}", index);
+                results[index].timings = engine.render(seeds[index], outputDirectory.getChildFile(name + ".wav"), outputDirectory.getChildFile(name + ".mid"));
+                results[index].latencyMs = juce::Time::getMillisecondCounterHiRes() - songStart;
+            }
+            cacheStats[static_cast<size_t>(worker)] = engine.getRepitchCacheStats();
+            noteCacheStats[static_cast<size_t>(worker)] = engine.getNoteCacheStats();
+        } catch (const std::exception& e) {
+            fmt::println(stderr, "worker {} failed: {}", worker, e.what());
+            failed = true;
+            // nobody else waits for a worker that's never going to be ready
+            startRendering.signal();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int worker = 0; worker < concurrency; ++worker) {
+        workers.emplace_back(work, worker);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (failed) {
+        return 1;
+    }
+    const auto elapsedMs = juce::Time::getMillisecondCounterHiRes() - startTime;
+
+    std::vector<double> latencies;
+    RenderTimings totals;
+    for (const auto& result : results) {
+        latencies.push_back(result.latencyMs);
+        totals.generateMs += result.timings.generateMs;
+        totals.prepareMs += result.timings.prepareMs;
+        totals.renderMs += result.timings.renderMs;
+        totals.writeMs += result.timings.writeMs;
+        totals.totalMs += result.timings.totalMs;
+    }
+
+    // summed over every worker's engine, warmup included
+    RepitchCacheStats cacheTotals;
+    RepitchCacheStats noteCacheTotals;
+    for (size_t worker = 0; worker < cacheStats.size(); ++worker) {
+        cacheTotals += cacheStats[worker];
+        noteCacheTotals += noteCacheStats[worker];
+    }
+
+    auto* config = new juce::DynamicObject();
+    config->setProperty("songs", static_cast<int>(seeds.size()));
+    config->setProperty("concurrency", concurrency);
+    config->setProperty("warmup", warmup);
+    config->setProperty("sample_rate", settings.sampleRate);
+    config->setProperty("preview", settings.isPreview);
+    config->setProperty("compact_samples", settings.compactSampleStorage);
+    config->setProperty("repitch_cache_mb", static_cast<double>(settings.repitchCacheBudgetBytes) / (1024.0 * 1024.0));
+    config->setProperty("note_cache_mb", static_cast<double>(settings.noteCacheBudgetBytes) / (1024.0 * 1024.0));
+    config->setProperty("convolution_reverb", !settings.impulseResponsePath.empty());
+    config->setProperty("simd", DSPKernels::get().name);
+#if JUCE_DEBUG
+    config->setProperty("build", "debug");
+#else
+    config->setProperty("build", "release");
+#endif
+
+    // what fraction of the engines' time went to each stage, summed over every song
+    auto* stageShares = new juce::DynamicObject();
+    stageShares->setProperty("generate", totals.generateMs / totals.totalMs);
+    stageShares->setProperty("prepare", totals.prepareMs / totals.totalMs);
+    stageShares->setProperty("render", totals.renderMs / totals.totalMs);
+    stageShares->setProperty("write", totals.writeMs / totals.totalMs);
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("config", juce::var(config));
+    report->setProperty("elapsed_ms", elapsedMs);
+    report->setProperty("songs_per_second", seeds.size() * 1000.0 / elapsedMs);
+    report->setProperty("latency_ms", percentiles(latencies));
+    report->setProperty("setup_ms", percentiles(setupMs));
+    report->setProperty("peak_rss_mb", getPeakResidentMegabytes());
+    report->setProperty("stage_share", juce::var(stageShares));
+    report->setProperty("repitch_cache", cacheReport(cacheTotals));
+    report->setProperty("note_cache", cacheReport(noteCacheTotals));
+    // one pool for the whole process, allocations stop climbing once every worker has rendered a song or two
+    const auto poolStats = AudioBufferPool::get().getStats();
+    auto* bufferPool = new juce::DynamicObject();
+    bufferPool->setProperty("allocations", poolStats.allocations);
+    bufferPool->setProperty("reuses", poolStats.reuses);
+    bufferPool->setProperty("pooled_mb", poolStats.pooledBytes / (1024.0 * 1024.0));
+    report->setProperty("buffer_pool", juce::var(bufferPool));
+
+    const auto json = juce::JSON::toString(juce::var(report));
+    if (args.containsOption("--output")) {
+        workingDirectory.getChildFile(args.getValueForOption("--output")).replaceWithText(json);
+    } else {
+        fmt::println("{}", json.toStdString());
+    }
+    return 0;
+}
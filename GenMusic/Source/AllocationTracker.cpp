@@ -0,0 +1,541 @@
+/*
+  ==============================================================================
+
+    AllocationTracker.cpp
+    Created: 19 Oct 2026 9:55:39am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "AllocationTracker.h"
+
+#if GENMUSIC_TRACK_ALLOCATIONS
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <pthread.h>
+#include <fmt/format.h>
+
+#if defined(__APPLE__)
+ #include <malloc/malloc.h>
+ #include <mach/mach.h>
+#endif
+
+// juce's HeapBlock, so every AudioBuffer, goes straight to malloc. Where malloc can be hooked operator new is left to
+// land in it and only the hooks count, anywhere else only operator new is seen
+#if defined(__GLIBC__) || defined(__APPLE__)
+ #define GENMUSIC_HOOKS_MALLOC 1
+#else
+ #define GENMUSIC_HOOKS_MALLOC 0
+#endif
+
+static constexpr int STAGE_COUNT = static_cast<int>(AllocationStage::Count);
+// threads past the last slot all share it
+static constexpr int MAX_THREADS = 64;
+
+static const char* const stageNames[STAGE_COUNT] = {"other", "generate", "prepare", "repitch", "render", "voice start", "voice render", "effects", "write"};
+
+struct AllocationCounters {
+    std::atomic<unsigned long long> allocations;
+    std::atomic<unsigned long long> bytes;
+    std::atomic<long long> liveBytes;
+    std::atomic<long long> peakLiveBytes;
+};
+
+// all of these are zero initialised before any code runs, so allocations from static constructors are safe to count
+static AllocationCounters stageCounters[STAGE_COUNT];
+static AllocationCounters totalCounters;
+// an allocation stays live on the thread that made it, whichever thread frees it
+static AllocationCounters threadCounters[MAX_THREADS];
+static std::atomic<unsigned long long> threadStageBytes[MAX_THREADS][STAGE_COUNT];
+static std::atomic<unsigned long long> unfollowedAllocations;
+static std::atomic<int> threadsSeen;
+static std::atomic<bool> failOnVoiceAllocation;
+
+// A thread_local can allocate the first time a thread touches it, which from inside malloc recurses. Keys don't, the
+// stage is stored as is (Other is null) and the slot plus one
+static pthread_key_t stageKey;
+static pthread_key_t slotKey;
+static std::atomic<bool> keysCreated;
+
+// Every live allocation by address, so a free knows its size, stage and thread without a header in front of the
+// memory (the allocator owns that, and frees memory allocated before the hooks went in). Open addressing in a fixed
+// table, following an allocation never allocates
+static constexpr int TABLE_BITS = 20;
+static constexpr std::size_t TABLE_SIZE = std::size_t(1) << TABLE_BITS;
+// an allocation with no room this close to its home isn't followed, it's counted but stays out of the live bytes
+static constexpr std::size_t MAX_PROBES = 64;
+static constexpr std::uintptr_t EMPTY = 0;
+static constexpr std::uintptr_t REMOVED = 1;
+
+struct FollowedAllocation {
+    std::atomic<std::uintptr_t> address;
+    // the size in the low 48 bits, then the stage and the thread slot
+    std::atomic<std::uint64_t> info;
+};
+static FollowedAllocation followed[TABLE_SIZE];
+
+static std::size_t getHome(std::uintptr_t address) {
+    return static_cast<std::size_t>(((static_cast<std::uint64_t>(address) >> 4) * 0x9E3779B97F4A7C15ull) >> (64 - TABLE_BITS));
+}
+
+static bool follow(std::uintptr_t address, std::uint64_t info) {
+    auto index = getHome(address);
+    for (std::size_t probe = 0; probe < MAX_PROBES; ++probe, index = (index + 1) & (TABLE_SIZE - 1)) {
+        auto& entry = followed[index];
+        auto current = entry.address.load(std::memory_order_relaxed);
+        while (current == EMPTY || current == REMOVED) {
+            if (entry.address.compare_exchange_weak(current, address, std::memory_order_acq_rel)) {
+                entry.info.store(info, std::memory_order_release);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static bool unfollow(std::uintptr_t address, std::uint64_t& info) {
+    auto index = getHome(address);
+    for (std::size_t probe = 0; probe < MAX_PROBES; ++probe, index = (index + 1) & (TABLE_SIZE - 1)) {
+        auto& entry = followed[index];
+        const auto current = entry.address.load(std::memory_order_acquire);
+        if (current == address) {
+            info = entry.info.load(std::memory_order_acquire);
+            entry.address.store(REMOVED, std::memory_order_release);
+            return true;
+        }
+        if (current == EMPTY) {
+            return false;
+        }
+    }
+    return false;
+}
+
+static std::uint64_t packInfo(std::size_t size, int stage, int slot) {
+    return (static_cast<std::uint64_t>(size) & 0xFFFFFFFFFFFFull) | (static_cast<std::uint64_t>(stage) << 48) | (static_cast<std::uint64_t>(slot) << 56);
+}
+
+static AllocationStage getCurrentStage() {
+    if (!keysCreated.load(std::memory_order_acquire)) {
+        return AllocationStage::Other;
+    }
+    return static_cast<AllocationStage>(reinterpret_cast<std::uintptr_t>(pthread_getspecific(stageKey)));
+}
+
+static int getThreadSlot() {
+    if (!keysCreated.load(std::memory_order_acquire)) {
+        return MAX_THREADS - 1;
+    }
+    auto stored = reinterpret_cast<std::uintptr_t>(pthread_getspecific(slotKey));
+    if (stored == 0) {
+        stored = static_cast<std::uintptr_t>(std::min(threadsSeen.fetch_add(1), MAX_THREADS - 1)) + 1;
+        pthread_setspecific(slotKey, reinterpret_cast<void*>(stored));
+    }
+    return static_cast<int>(stored - 1);
+}
+
+static void raisePeak(std::atomic<long long>& peak, long long value) {
+    auto current = peak.load(std::memory_order_relaxed);
+    while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+static void addLive(AllocationCounters& counters, long long size) {
+    raisePeak(counters.peakLiveBytes, counters.liveBytes.fetch_add(size, std::memory_order_relaxed) + size);
+}
+
+static void changeLive(std::uint64_t info, long long sign) {
+    const auto size = sign * static_cast<long long>(info & 0xFFFFFFFFFFFFull);
+    const auto stage = static_cast<int>((info >> 48) & 0xFF);
+    const auto slot = static_cast<int>(info >> 56);
+    if (sign > 0) {
+        addLive(stageCounters[stage], size);
+        addLive(totalCounters, size);
+        addLive(threadCounters[slot], size);
+    } else {
+        stageCounters[stage].liveBytes.fetch_add(size, std::memory_order_relaxed);
+        totalCounters.liveBytes.fetch_add(size, std::memory_order_relaxed);
+        threadCounters[slot].liveBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+}
+
+static void countAllocation(AllocationCounters& counters, std::size_t size) {
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    counters.bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+static void track(void* pointer, std::size_t size) {
+    if (pointer == nullptr) {
+        return;
+    }
+    const auto stage = getCurrentStage();
+    if (stage == AllocationStage::VoiceRender && failOnVoiceAllocation.load(std::memory_order_relaxed)) {
+        std::fputs("allocation in the voice render path\n", stderr);
+        std::abort();
+    }
+    
+    const auto stageIndex = static_cast<int>(stage);
+    const auto slot = getThreadSlot();
+    countAllocation(stageCounters[stageIndex], size);
+    countAllocation(totalCounters, size);
+    countAllocation(threadCounters[slot], size);
+    threadStageBytes[slot][stageIndex].fetch_add(size, std::memory_order_relaxed);
+    
+    const auto info = packInfo(size, stageIndex, slot);
+    if (follow(reinterpret_cast<std::uintptr_t>(pointer), info)) {
+        changeLive(info, 1);
+    } else {
+        unfollowedAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// has to happen before the memory goes back, after that the allocator can hand the address to another thread
+static bool untrack(void* pointer, std::uint64_t& info) {
+    if (pointer == nullptr || !unfollow(reinterpret_cast<std::uintptr_t>(pointer), info)) {
+        return false;
+    }
+    changeLive(info, -1);
+    return true;
+}
+
+template <typename Reallocate>
+static void* trackedRealloc(void* pointer, std::size_t size, Reallocate&& reallocate) {
+    std::uint64_t info = 0;
+    const bool wasFollowed = untrack(pointer, info);
+    auto* result = reallocate(pointer, size);
+    if (result != nullptr) {
+        track(result, size);
+    } else if (wasFollowed && size != 0) {
+        // it failed and the old block is still there
+        if (follow(reinterpret_cast<std::uintptr_t>(pointer), info)) {
+            changeLive(info, 1);
+        }
+    }
+    return result;
+}
+
+#if defined(__GLIBC__)
+
+// glibc looks malloc and friends up like any other symbol, so defining them here puts the executable's in front of
+// its own, which stay reachable under these names
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* pointer, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+void __libc_free(void* pointer);
+
+void* malloc(std::size_t size) noexcept {
+    auto* pointer = __libc_malloc(size);
+    track(pointer, size);
+    return pointer;
+}
+
+void* calloc(std::size_t count, std::size_t size) noexcept {
+    auto* pointer = __libc_calloc(count, size);
+    track(pointer, count * size);
+    return pointer;
+}
+
+void* realloc(void* pointer, std::size_t size) noexcept {
+    return trackedRealloc(pointer, size, [](void* previous, std::size_t newSize) { return __libc_realloc(previous, newSize); });
+}
+
+void* memalign(std::size_t alignment, std::size_t size) noexcept {
+    auto* pointer = __libc_memalign(alignment, size);
+    track(pointer, size);
+    return pointer;
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept {
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void** result, std::size_t alignment, std::size_t size) noexcept {
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    auto* pointer = memalign(alignment, size);
+    if (pointer == nullptr) {
+        return ENOMEM;
+    }
+    *result = pointer;
+    return 0;
+}
+
+void free(void* pointer) noexcept {
+    std::uint64_t info = 0;
+    untrack(pointer, info);
+    __libc_free(pointer);
+}
+}
+
+static void installMallocHooks() {}
+
+#elif defined(__APPLE__)
+
+// The system allocator can't be replaced by symbol, but every malloc and free goes through a zone's function table.
+// The zones there at startup get their entries swapped for these, which count and call the zone's own
+static constexpr int MAX_ZONES = 8;
+
+struct HookedZone {
+    malloc_zone_t* zone;
+    malloc_zone_t original;
+};
+static HookedZone hookedZones[MAX_ZONES];
+static std::atomic<int> numHookedZones;
+
+static const malloc_zone_t& getOriginal(malloc_zone_t* zone) {
+    const int count = numHookedZones.load(std::memory_order_acquire);
+    for (int i = 0; i < count; ++i) {
+        if (hookedZones[i].zone == zone) {
+            return hookedZones[i].original;
+        }
+    }
+    // only zones that have been hooked call in here
+    std::abort();
+}
+
+static void* zoneMalloc(malloc_zone_t* zone, size_t size) {
+    auto* pointer = getOriginal(zone).malloc(zone, size);
+    track(pointer, size);
+    return pointer;
+}
+
+static void* zoneCalloc(malloc_zone_t* zone, size_t count, size_t size) {
+    auto* pointer = getOriginal(zone).calloc(zone, count, size);
+    track(pointer, count * size);
+    return pointer;
+}
+
+static void* zoneValloc(malloc_zone_t* zone, size_t size) {
+    auto* pointer = getOriginal(zone).valloc(zone, size);
+    track(pointer, size);
+    return pointer;
+}
+
+static void* zoneRealloc(malloc_zone_t* zone, void* pointer, size_t size) {
+    return trackedRealloc(pointer, size, [zone](void* previous, std::size_t newSize) { return getOriginal(zone).realloc(zone, previous, newSize); });
+}
+
+static void* zoneMemalign(malloc_zone_t* zone, size_t alignment, size_t size) {
+    auto* pointer = getOriginal(zone).memalign(zone, alignment, size);
+    track(pointer, size);
+    return pointer;
+}
+
+static void zoneFree(malloc_zone_t* zone, void* pointer) {
+    std::uint64_t info = 0;
+    untrack(pointer, info);
+    getOriginal(zone).free(zone, pointer);
+}
+
+static void zoneFreeDefiniteSize(malloc_zone_t* zone, void* pointer, size_t size) {
+    std::uint64_t info = 0;
+    untrack(pointer, info);
+    getOriginal(zone).free_definite_size(zone, pointer, size);
+}
+
+static unsigned zoneBatchMalloc(malloc_zone_t* zone, size_t size, void** results, unsigned count) {
+    const auto allocated = getOriginal(zone).batch_malloc(zone, size, results, count);
+    for (unsigned i = 0; i < allocated; ++i) {
+        track(results[i], size);
+    }
+    return allocated;
+}
+
+static void zoneBatchFree(malloc_zone_t* zone, void** pointers, unsigned count) {
+    for (unsigned i = 0; i < count; ++i) {
+        std::uint64_t info = 0;
+        untrack(pointers[i], info);
+    }
+    getOriginal(zone).batch_free(zone, pointers, count);
+}
+
+static void hookZone(malloc_zone_t* zone) {
+    const int index = numHookedZones.load(std::memory_order_relaxed);
+    if (index == MAX_ZONES) {
+        return;
+    }
+    hookedZones[index].zone = zone;
+    hookedZones[index].original = *zone;
+    numHookedZones.store(index + 1, std::memory_order_release);
+    
+    // the system's zones are read only once they're set up, they go back to however they were
+    vm_address_t region = reinterpret_cast<vm_address_t>(zone);
+    vm_size_t regionSize = 0;
+    vm_region_basic_info_data_64_t regionInfo;
+    mach_msg_type_number_t infoCount = VM_REGION_BASIC_INFO_COUNT_64;
+    mach_port_t objectName;
+    const bool knowsProtection = vm_region_64(mach_task_self(), &region, &regionSize, VM_REGION_BASIC_INFO_64, reinterpret_cast<vm_region_info_t>(&regionInfo), &infoCount, &objectName) == KERN_SUCCESS;
+    vm_protect(mach_task_self(), reinterpret_cast<vm_address_t>(zone), sizeof(malloc_zone_t), false, VM_PROT_READ | VM_PROT_WRITE);
+    
+    zone->malloc = zoneMalloc;
+    zone->calloc = zoneCalloc;
+    zone->valloc = zoneValloc;
+    zone->realloc = zoneRealloc;
+    zone->free = zoneFree;
+    if (zone->batch_malloc != nullptr) {
+        zone->batch_malloc = zoneBatchMalloc;
+    }
+    if (zone->batch_free != nullptr) {
+        zone->batch_free = zoneBatchFree;
+    }
+    if (zone->version >= 5 && zone->memalign != nullptr) {
+        zone->memalign = zoneMemalign;
+    }
+    if (zone->version >= 6 && zone->free_definite_size != nullptr) {
+        zone->free_definite_size = zoneFreeDefiniteSize;
+    }
+    
+    if (knowsProtection) {
+        vm_protect(mach_task_self(), reinterpret_cast<vm_address_t>(zone), sizeof(malloc_zone_t), false, regionInfo.protection);
+    }
+}
+
+static void installMallocHooks() {
+    vm_address_t* zones = nullptr;
+    unsigned count = 0;
+    if (malloc_get_all_zones(mach_task_self(), nullptr, &zones, &count) != KERN_SUCCESS) {
+        return;
+    }
+    for (unsigned i = 0; i < count; ++i) {
+        hookZone(reinterpret_cast<malloc_zone_t*>(zones[i]));
+    }
+}
+
+#else
+
+static void installMallocHooks() {}
+
+#endif
+
+static bool install() {
+    if (pthread_key_create(&stageKey, nullptr) == 0 && pthread_key_create(&slotKey, nullptr) == 0) {
+        keysCreated.store(true, std::memory_order_release);
+    }
+    installMallocHooks();
+    return true;
+}
+
+// before main, so the counts cover everything the app does
+[[maybe_unused]] static const bool installed = install();
+
+void* operator new(std::size_t size) {
+    auto* pointer = std::malloc(size == 0 ? 1 : size);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+#if ! GENMUSIC_HOOKS_MALLOC
+    track(pointer, size);
+#endif
+    return pointer;
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+
+void operator delete(void* pointer) noexcept {
+#if ! GENMUSIC_HOOKS_MALLOC
+    std::uint64_t info = 0;
+    untrack(pointer, info);
+#endif
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept { operator delete(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { operator delete(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { operator delete(pointer); }
+
+AllocationStage AllocationTracker::setStage(AllocationStage stage) {
+    if (!keysCreated.load(std::memory_order_acquire)) {
+        return AllocationStage::Other;
+    }
+    const auto previous = getCurrentStage();
+    pthread_setspecific(stageKey, reinterpret_cast<void*>(static_cast<std::uintptr_t>(stage)));
+    return previous;
+}
+
+static void restartCounters(AllocationCounters& counters) {
+    counters.allocations = 0;
+    counters.bytes = 0;
+    counters.peakLiveBytes = counters.liveBytes.load();
+}
+
+void AllocationTracker::beginRender() {
+    for (auto& counters : stageCounters) {
+        restartCounters(counters);
+    }
+    restartCounters(totalCounters);
+    for (int thread = 0; thread < MAX_THREADS; ++thread) {
+        restartCounters(threadCounters[thread]);
+        for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+            threadStageBytes[thread][stage] = 0;
+        }
+    }
+    unfollowedAllocations = 0;
+}
+
+static double toMegabytes(long long bytes) {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+std::string AllocationTracker::getSummary() {
+    // snapshot first, building the summary allocates too
+    struct Snapshot {
+        unsigned long long allocations;
+        unsigned long long bytes;
+        long long peakLiveBytes;
+    };
+    auto snapshot = [](const AllocationCounters& counters) {
+        return Snapshot {counters.allocations.load(), counters.bytes.load(), counters.peakLiveBytes.load()};
+    };
+    Snapshot stages[STAGE_COUNT + 1];
+    for (int stage = 0; stage <= STAGE_COUNT; ++stage) {
+        stages[stage] = snapshot(stage < STAGE_COUNT ? stageCounters[stage] : totalCounters);
+    }
+    const auto threads = std::min(threadsSeen.load(), MAX_THREADS);
+    Snapshot threadTotals[MAX_THREADS] = {};
+    int threadBusiestStage[MAX_THREADS] = {};
+    for (int thread = 0; thread < threads; ++thread) {
+        threadTotals[thread] = snapshot(threadCounters[thread]);
+        unsigned long long busiestBytes = 0;
+        for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+            const auto bytes = threadStageBytes[thread][stage].load();
+            if (bytes > busiestBytes) {
+                busiestBytes = bytes;
+                threadBusiestStage[thread] = stage;
+            }
+        }
+    }
+    const auto unfollowed = unfollowedAllocations.load();
+    
+    std::string summary = fmt::format("{:<14}{:>12}{:>14}{:>16}\n", "stage", "allocations", "allocated MB", "peak live MB");
+    for (int stage = 0; stage <= STAGE_COUNT; ++stage) {
+        if (stages[stage].allocations == 0 && stage < STAGE_COUNT) {
+            continue;
+        }
+        summary += fmt::format("{:<14}{:>12}{:>14.2f}{:>16.2f}\n", stage < STAGE_COUNT ? stageNames[stage] : "total", stages[stage].allocations, toMegabytes(static_cast<long long>(stages[stage].bytes)), toMegabytes(stages[stage].peakLiveBytes));
+    }
+    for (int thread = 0; thread < threads; ++thread) {
+        if (threadTotals[thread].allocations == 0) {
+            continue;
+        }
+        summary += fmt::format("thread {}{}: {} allocations, {:.2f} MB, {:.2f} MB peak live, mostly {}\n", thread, thread == MAX_THREADS - 1 ? "+" : "", threadTotals[thread].allocations, toMegabytes(static_cast<long long>(threadTotals[thread].bytes)), toMegabytes(threadTotals[thread].peakLiveBytes), stageNames[threadBusiestStage[thread]]);
+    }
+    if (unfollowed > 0) {
+        summary += fmt::format("{} allocations had no room to be followed and are left out of the live counts\n", unfollowed);
+    }
+    return summary;
+}
+
+void AllocationTracker::setFailOnVoiceAllocation(bool shouldFail) {
+    failOnVoiceAllocation = shouldFail;
+}
+
+#endif
@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    AllocationTracker.h
+    Created: 19 Oct 2026 9:55:39am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <string>
+
+// Opt-in: with GENMUSIC_TRACK_ALLOCATIONS=1 in the preprocessor definitions malloc and free are hooked (on macOS and
+// glibc, elsewhere only operator new and delete are replaced) and every heap allocation, AudioBuffers included, is
+// counted against the pipeline stage its thread is in and the thread that made it. Without it the stage scopes
+// compile to nothing.
+#ifndef GENMUSIC_TRACK_ALLOCATIONS
+ #define GENMUSIC_TRACK_ALLOCATIONS 0
+#endif
+
+enum class AllocationStage : unsigned char {
+    Other,
+    Generate,
+    Prepare,
+    Repitch,
+    Render,
+    // the copy of a note's audio a voice takes when it starts
+    VoiceStart,
+    VoiceRender,
+    Effects,
+    Write,
+    Count
+};
+
+class AllocationTracker {
+public:
+    static constexpr bool isEnabled() { return GENMUSIC_TRACK_ALLOCATIONS != 0; }
+    
+    // this thread's allocations count against stage until the scope ends, scopes nest
+    class StageScope {
+    public:
+        explicit StageScope(AllocationStage stage) : previous(setStage(stage)) {}
+        ~StageScope() { setStage(previous); }
+        StageScope(const StageScope&) = delete;
+        StageScope& operator=(const StageScope&) = delete;
+        
+    private:
+        AllocationStage previous;
+    };
+    
+    // returns the stage the thread was in
+    static AllocationStage setStage(AllocationStage stage);
+    
+    // zeroes the counts and restarts the high water marks from what's live right now
+    static void beginRender();
+    // allocations, bytes and peak live bytes per stage, then per thread, since beginRender
+    static std::string getSummary();
+    // any allocation in a VoiceRender scope prints a message and aborts
+    static void setFailOnVoiceAllocation(bool shouldFail);
+};
+
+#if ! GENMUSIC_TRACK_ALLOCATIONS
+inline AllocationStage AllocationTracker::setStage(AllocationStage) { return AllocationStage::Other; }
+inline void AllocationTracker::beginRender() {}
+inline std::string AllocationTracker::getSummary() { return {}; }
+inline void AllocationTracker::setFailOnVoiceAllocation(bool) {}
+#endif
@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    AudioBufferPool.cpp
+    Created: 19 Oct 2026 10:33:45am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "AudioBufferPool.h"
+
+// buffers up to this many bytes stay with the thread that released them, a few of each size at most
+const std::size_t THREAD_BUFFER_MAX_BYTES = 1024 * 1024;
+const size_t THREAD_BUFFERS_PER_SIZE = 4;
+const int SMALLEST_CAPACITY = 256;
+// what the shared lists may hold, a few songs' worth of busses
+const std::size_t SHARED_BUDGET_BYTES = 1024 * 1024 * 1024;
+
+static std::size_t getSizeInBytes(int numChannels, int capacity) {
+    return static_cast<std::size_t>(numChannels) * static_cast<std::size_t>(capacity) * sizeof(float);
+}
+
+PooledAudioBuffer::PooledAudioBuffer(std::unique_ptr<juce::AudioBuffer<float>> buffer, int capacity) : buffer(std::move(buffer)), capacity(capacity) {
+
+}
+
+PooledAudioBuffer& PooledAudioBuffer::operator=(PooledAudioBuffer&& other) noexcept {
+    if (this != &other) {
+        if (buffer != nullptr) {
+            AudioBufferPool::get().release(std::move(buffer), capacity);
+        }
+        buffer = std::move(other.buffer);
+        capacity = other.capacity;
+    }
+    return *this;
+}
+
+PooledAudioBuffer::~PooledAudioBuffer() {
+    if (buffer != nullptr) {
+        AudioBufferPool::get().release(std::move(buffer), capacity);
+    }
+}
+
+AudioBufferPool& AudioBufferPool::get() {
+    static AudioBufferPool pool;
+    return pool;
+}
+
+AudioBufferPool::FreeLists& AudioBufferPool::getThreadFreeLists() {
+    thread_local FreeLists freeLists;
+    return freeLists;
+}
+
+int AudioBufferPool::getCapacity(int numSamples) {
+    if (numSamples <= SMALLEST_CAPACITY) {
+        return SMALLEST_CAPACITY;
+    }
+    // rounded up to the next quarter of the power of two below it
+    const int step = juce::nextPowerOfTwo(numSamples + 1) / 8;
+    return (numSamples + step - 1) / step * step;
+}
+
+PooledAudioBuffer AudioBufferPool::acquire(int numChannels, int numSamples) {
+    const int capacity = getCapacity(numSamples);
+    const Key key {numChannels, capacity};
+    std::unique_ptr<juce::AudioBuffer<float>> buffer;
+
+    auto& threadFreeLists = getThreadFreeLists();
+    auto threadList = threadFreeLists.find(key);
+    if (threadList != threadFreeLists.end() && !threadList->second.empty()) {
+        buffer = std::move(threadList->second.back());
+        threadList->second.pop_back();
+    } else {
+        const juce::ScopedLock scopedLock(lock);
+        auto sharedList = sharedFreeLists.find(key);
+        if (sharedList != sharedFreeLists.end() && !sharedList->second.empty()) {
+            buffer = std::move(sharedList->second.back());
+            sharedList->second.pop_back();
+            pooledBytes -= getSizeInBytes(numChannels, capacity);
+        }
+    }
+
+    if (buffer != nullptr) {
+        reuses++;
+    } else {
+        allocations++;
+        buffer = std::make_unique<juce::AudioBuffer<float>>(numChannels, capacity);
+    }
+    buffer->setSize(numChannels, numSamples, false, false, true);
+    return PooledAudioBuffer(std::move(buffer), capacity);
+}
+
+void AudioBufferPool::release(std::unique_ptr<juce::AudioBuffer<float>> buffer, int capacity) {
+    // grown past what it was handed out with, the allocation isn't the one the class promises any more
+    if (buffer->getNumSamples() > capacity) {
+        return;
+    }
+
+    const auto numChannels = buffer->getNumChannels();
+    const auto bytes = getSizeInBytes(numChannels, capacity);
+    const Key key {numChannels, capacity};
+
+    if (bytes <= THREAD_BUFFER_MAX_BYTES) {
+        auto& threadList = getThreadFreeLists()[key];
+        if (threadList.size() < THREAD_BUFFERS_PER_SIZE) {
+            threadList.push_back(std::move(buffer));
+            return;
+        }
+    }
+
+    const juce::ScopedLock scopedLock(lock);
+    if (pooledBytes + bytes > SHARED_BUDGET_BYTES) {
+        return;
+    }
+    sharedFreeLists[key].push_back(std::move(buffer));
+    pooledBytes += bytes;
+}
+
+AudioBufferPoolStats AudioBufferPool::getStats() const {
+    const juce::ScopedLock scopedLock(lock);
+    return {allocations.load(), reuses.load(), pooledBytes};
+}
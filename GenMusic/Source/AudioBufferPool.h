@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    AudioBufferPool.h
+    Created: 19 Oct 2026 10:33:45am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+
+class AudioBufferPool;
+
+// A buffer on loan from the pool, it goes back when this is destroyed. It can be resized freely up to the size it was
+// acquired with (setSize with avoidReallocating), growing it past that just means the pool frees it instead
+class PooledAudioBuffer {
+public:
+    PooledAudioBuffer() = default;
+    PooledAudioBuffer(PooledAudioBuffer&& other) noexcept = default;
+    PooledAudioBuffer& operator=(PooledAudioBuffer&& other) noexcept;
+    ~PooledAudioBuffer();
+
+    juce::AudioBuffer<float>& operator*() const { return *buffer; }
+    juce::AudioBuffer<float>* operator->() const { return buffer.get(); }
+    juce::AudioBuffer<float>* get() const { return buffer.get(); }
+
+private:
+    friend class AudioBufferPool;
+    PooledAudioBuffer(std::unique_ptr<juce::AudioBuffer<float>> buffer, int capacity);
+
+    std::unique_ptr<juce::AudioBuffer<float>> buffer;
+    int capacity = 0;
+};
+
+struct AudioBufferPoolStats {
+    // buffers that had to be allocated, once the pool is warm this stops moving
+    juce::int64 allocations = 0;
+    juce::int64 reuses = 0;
+    // held by the shared lists, the threads' own lists aren't counted
+    std::size_t pooledBytes = 0;
+};
+
+/*
+    Float buffers by size class, handed out and taken back so that a render that's been done once before doesn't go
+    near the allocator again: every bus, loop and scratch buffer a song needs is sitting in the pool from the last one.
+    Classes are a quarter of an octave apart in samples per channel, so a buffer is never more than a quarter bigger
+    than asked for.
+
+    Small buffers go back to a short list of the releasing thread's own and are taken from there first, a render
+    thread asking for the same scratch sizes over and over never takes the lock. Big ones, the whole song buses, go to
+    the shared lists so they can't get stranded on a thread that won't ask for them again, and past the byte budget
+    they're freed instead of kept.
+ */
+class AudioBufferPool {
+public:
+    static AudioBufferPool& get();
+
+    // numChannels by numSamples, the contents are whatever was left in it
+    PooledAudioBuffer acquire(int numChannels, int numSamples);
+
+    AudioBufferPoolStats getStats() const;
+
+private:
+    friend class PooledAudioBuffer;
+    using Key = std::pair<int, int>;
+    using FreeLists = std::map<Key, std::vector<std::unique_ptr<juce::AudioBuffer<float>>>>;
+
+    AudioBufferPool() = default;
+    void release(std::unique_ptr<juce::AudioBuffer<float>> buffer, int capacity);
+    static int getCapacity(int numSamples);
+    static FreeLists& getThreadFreeLists();
+
+    mutable juce::CriticalSection lock;
+    FreeLists sharedFreeLists;
+    std::size_t pooledBytes = 0;
+    std::atomic<juce::int64> allocations { 0 };
+    std::atomic<juce::int64> reuses { 0 };
+};
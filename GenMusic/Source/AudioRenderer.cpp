@@ -10,12 +10,246 @@
 
 #include "AudioRenderer.h"
 #include <fmt/core.h>
+#include <map>
+#include <tuple>
+#include "Utilities.h"
+#include "Voices.h"
+#include "DSPKernels.h"
+#include "AudioBufferPool.h"
 
-AudioRenderer::AudioRenderer(double sampleRate) : sampleRate(sampleRate) {}
+// how long past its note off a single note may ring before it's taken to be stuck and left to the synth
+const double MAX_NOTE_TAIL_SECONDS = 30.0;
+
+AudioRenderer::AudioRenderer(double sampleRate, RenderedNoteCache* noteCache) : sampleRate(sampleRate), noteCache(noteCache) {}
+
+// Splits the sequence into loops by note on time and checks every loop plays the same notes as the first (to within
+// a sample, the note times are truncated to whole samples). On success firstLoop holds the first loop's events.
+static bool extractRepeatedLoop(juce::MidiMessageSequence& sequence, double loopLengthInSamples, int loopCount, juce::MidiMessageSequence& firstLoop) {
+    struct LoopNote {
+        int noteNumber;
+        int velocity;
+        double start;
+        double end;
+    };
+    
+    sequence.updateMatchedPairs();
+    std::vector<std::vector<LoopNote>> loops(loopCount);
+    int noteOffs = 0;
+    int matchedNoteOns = 0;
+    
+    for (int i = 0; i < sequence.getNumEvents(); ++i) {
+        auto* event = sequence.getEventPointer(i);
+        const auto& message = event->message;
+        if (message.isNoteOff()) {
+            noteOffs++;
+            continue;
+        }
+        if (!message.isNoteOn() || event->noteOffObject == nullptr) {
+            return false;
+        }
+        matchedNoteOns++;
+        
+        const double start = message.getTimeStamp();
+        const int loop = static_cast<int>(std::floor((start + 1.0) / loopLengthInSamples));
+        if (loop < 0 || loop >= loopCount) {
+            return false;
+        }
+        
+        const double loopStart = loop * loopLengthInSamples;
+        loops[loop].push_back({message.getNoteNumber(), message.getVelocity(), start - loopStart, event->noteOffObject->message.getTimeStamp() - loopStart});
+        
+        if (loop == 0) {
+            firstLoop.addEvent(message);
+            firstLoop.addEvent(event->noteOffObject->message);
+        }
+    }
+    
+    // stray note offs would change what the voices do, leave those sequences to the full render
+    if (noteOffs != matchedNoteOns) {
+        return false;
+    }
+    
+    auto byStart = [](const LoopNote& a, const LoopNote& b) {
+        return std::tie(a.start, a.noteNumber, a.end) < std::tie(b.start, b.noteNumber, b.end);
+    };
+    std::sort(loops[0].begin(), loops[0].end(), byStart);
+    
+    for (int loop = 1; loop < loopCount; ++loop) {
+        auto& notes = loops[loop];
+        if (notes.size() != loops[0].size()) {
+            return false;
+        }
+        std::sort(notes.begin(), notes.end(), byStart);
+        for (size_t i = 0; i < notes.size(); ++i) {
+            const auto& expected = loops[0][i];
+            if (notes[i].noteNumber != expected.noteNumber || notes[i].velocity != expected.velocity
+                || std::abs(notes[i].start - expected.start) > 1.0 || std::abs(notes[i].end - expected.end) > 1.0) {
+                return false;
+            }
+        }
+    }
+    
+    return true;
+}
+
+static bool isAnyVoiceActive(juce::Synthesiser& synth) {
+    for (int i = 0; i < synth.getNumVoices(); ++i) {
+        if (synth.getVoice(i)->isVoiceActive()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// One note played through the synth on its own, from note on until the last voice lets go. nullptr if it's still
+// going MAX_NOTE_TAIL_SECONDS after the note off
+static std::shared_ptr<const juce::AudioBuffer<float>> renderIsolatedNote(juce::Synthesiser& synth, int numChannels, const juce::MidiMessage& noteOn, int durationInSamples, int releaseInSamples, double sampleRate) {
+    juce::MidiBuffer midiBuffer;
+    midiBuffer.addEvent(noteOn, 0);
+    midiBuffer.addEvent(juce::MidiMessage::noteOff(noteOn.getChannel(), noteOn.getNoteNumber()), durationInSamples);
+    
+    // room for the whole release up front, it only has to grow for a voice that outlasts its envelope
+    auto note = std::make_shared<juce::AudioBuffer<float>>(numChannels, durationInSamples + 1 + releaseInSamples + CHUNK_SIZE);
+    note->clear();
+    int renderedLength = durationInSamples + 1;
+    synth.renderNextBlock(*note, midiBuffer, 0, renderedLength);
+    
+    // then the release, a chunk at a time
+    const int maxLength = durationInSamples + static_cast<int>(MAX_NOTE_TAIL_SECONDS * sampleRate);
+    const juce::MidiBuffer noEvents;
+    while (isAnyVoiceActive(synth)) {
+        if (renderedLength >= maxLength) {
+            synth.allNotesOff(0, false);
+            return nullptr;
+        }
+        if (renderedLength + CHUNK_SIZE > note->getNumSamples()) {
+            note->setSize(numChannels, std::max(renderedLength + CHUNK_SIZE, note->getNumSamples() * 2), true, true, false);
+        }
+        synth.renderNextBlock(*note, noEvents, renderedLength, CHUNK_SIZE);
+        renderedLength += CHUNK_SIZE;
+    }
+    
+    // the envelope closes part way through the last chunk, everything after it is silence
+    int length = renderedLength;
+    while (length > 0 && note->getMagnitude(length - 1, 1) == 0.0f) {
+        --length;
+    }
+    // a tight copy, the cache counts a note by its length
+    note->setSize(numChannels, length, true, false, false);
+    return note;
+}
+
+bool AudioRenderer::renderFromNoteCache(juce::AudioBuffer<float>& buffer, juce::MidiMessageSequence* sequence, juce::Synthesiser* synth) {
+    // a note is only rendered once for every voice when they'd all play it the same
+    std::size_t voiceIdentity = 0;
+    double releaseSeconds = 0.0;
+    for (int i = 0; i < synth->getNumVoices(); ++i) {
+        auto* voice = dynamic_cast<SampleVoice*>(synth->getVoice(i));
+        if (voice == nullptr || voice->isVoiceActive() || (i > 0 && voice->getIdentityHash() != voiceIdentity)) {
+            return false;
+        }
+        voiceIdentity = voice->getIdentityHash();
+        releaseSeconds = voice->getReleaseSeconds();
+    }
+    if (synth->getNumVoices() == 0) {
+        return false;
+    }
+    const int releaseInSamples = static_cast<int>(std::ceil(releaseSeconds * sampleRate));
+    
+    struct CachedPlay {
+        int start;
+        // exact for a cached note, for one still to be rendered the note off plus the whole release
+        int end;
+        int noteNumber;
+        RenderedNoteCache::Key key;
+        const juce::MidiMessage* noteOn;
+        int duration;
+        std::shared_ptr<const juce::AudioBuffer<float>> audio;
+    };
+    std::vector<CachedPlay> plays;
+    
+    sequence->updateMatchedPairs();
+    int noteOffs = 0;
+    for (int i = 0; i < sequence->getNumEvents(); ++i) {
+        auto* event = sequence->getEventPointer(i);
+        const auto& message = event->message;
+        if (message.isNoteOff()) {
+            noteOffs++;
+            continue;
+        }
+        if (!message.isNoteOn() || event->noteOffObject == nullptr) {
+            return false;
+        }
+        
+        // truncated to whole samples the same way renderMIDISequence places them
+        const int start = static_cast<int>(message.getTimeStamp());
+        const int duration = static_cast<int>(event->noteOffObject->message.getTimeStamp()) - start;
+        if (start < 0 || duration < 0) {
+            return false;
+        }
+        const RenderedNoteCache::Key key { voiceIdentity, message.getNoteNumber(), message.getVelocity(), duration, sampleRate };
+        auto audio = noteCache->find(key);
+        // a note that renders to nothing still holds a voice for a moment
+        const int end = audio != nullptr ? start + std::max(1, audio->getNumSamples()) : start + duration + 1 + releaseInSamples;
+        plays.push_back({start, end, message.getNoteNumber(), key, &message, duration, audio});
+    }
+    if (noteOffs != static_cast<int>(plays.size())) {
+        return false;
+    }
+    
+    // The synth would steal a voice once more notes ring at the same time than it has, and cut a note short when the
+    // same pitch is played again while it's still ringing. A note rendered on its own can't do either, those sequences
+    // go through the synth. Checked before any missing note is rendered so a sequence that fails costs one render
+    std::sort(plays.begin(), plays.end(), [](const CachedPlay& a, const CachedPlay& b) { return a.start < b.start; });
+    std::vector<const CachedPlay*> ringing;
+    for (const auto& play : plays) {
+        ringing.erase(std::remove_if(ringing.begin(), ringing.end(), [&](const CachedPlay* other) { return other->end <= play.start; }), ringing.end());
+        if (static_cast<int>(ringing.size()) >= synth->getNumVoices()) {
+            return false;
+        }
+        for (const auto* other : ringing) {
+            if (other->noteNumber == play.noteNumber) {
+                return false;
+            }
+        }
+        ringing.push_back(&play);
+    }
+    
+    // the same note repeats within a sequence, it's only rendered the first time even if the cache can't keep it
+    std::map<RenderedNoteCache::Key, std::shared_ptr<const juce::AudioBuffer<float>>> rendered;
+    for (auto& play : plays) {
+        if (play.audio != nullptr) {
+            continue;
+        }
+        auto& audio = rendered[play.key];
+        if (audio == nullptr) {
+            audio = renderIsolatedNote(*synth, buffer.getNumChannels(), *play.noteOn, play.duration, releaseInSamples, sampleRate);
+            if (audio == nullptr) {
+                return false;
+            }
+            noteCache->store(play.key, audio);
+        }
+        play.audio = audio;
+    }
+    
+    logVerbose("Rendering {} notes from the note cache", plays.size());
+    const auto& kernels = DSPKernels::get();
+    for (const auto& play : plays) {
+        const int numSamples = std::min(play.audio->getNumSamples(), buffer.getNumSamples() - play.start);
+        for (int channel = 0; numSamples > 0 && channel < play.audio->getNumChannels(); ++channel) {
+            kernels.addScaled(buffer.getWritePointer(channel, play.start), play.audio->getReadPointer(channel), 1.0f, numSamples);
+        }
+    }
+    return true;
+}
 
 void AudioRenderer::renderMIDISequence(juce::AudioBuffer<float>& buffer, juce::MidiMessageSequence* sequence, juce::Synthesiser* synth) {
+    if (noteCache != nullptr && renderFromNoteCache(buffer, sequence, synth)) {
+        return;
+    }
+    
     juce::MidiBuffer midiBuffer;
-    fmt::println("Rendering MIDI sequence {}", sequence->getNumEvents());
+    logVerbose("Rendering MIDI sequence {}", sequence->getNumEvents());
     for (int i = 0; i < sequence->getNumEvents(); ++i) {
         auto* midiEvent = sequence->getEventPointer(i);
         int sampleNumber = static_cast<int>(midiEvent->message.getTimeStamp()); // Convert time to samples
@@ -24,3 +258,34 @@ void AudioRenderer::renderMIDISequence(juce::AudioBuffer<float>& buffer, juce::M
     
     synth->renderNextBlock(buffer, midiBuffer, 0, buffer.getNumSamples());
 }
+
+void AudioRenderer::renderLoopedMIDISequence(juce::AudioBuffer<float>& buffer, juce::MidiMessageSequence* sequence, juce::Synthesiser* synth, double loopLengthInSamples, int loopCount) {
+    juce::MidiMessageSequence firstLoop;
+    if (loopCount < 2 || loopLengthInSamples <= 0 || !extractRepeatedLoop(*sequence, loopLengthInSamples, loopCount, firstLoop)) {
+        renderMIDISequence(buffer, sequence, synth);
+        return;
+    }
+    
+    // the first loop is rendered as long as the last one has left in the buffer, so every copy carries the same tail
+    const int lastLoopStart = static_cast<int>(std::round((loopCount - 1) * loopLengthInSamples));
+    const int loopRenderLength = buffer.getNumSamples() - lastLoopStart;
+    if (loopRenderLength <= 0) {
+        renderMIDISequence(buffer, sequence, synth);
+        return;
+    }
+    
+    logVerbose("Rendering one of {} identical loops", loopCount);
+    auto pooledLoop = AudioBufferPool::get().acquire(buffer.getNumChannels(), loopRenderLength);
+    auto& loopBuffer = *pooledLoop;
+    loopBuffer.clear();
+    renderMIDISequence(loopBuffer, &firstLoop, synth);
+    
+    // overlap-add, each loop's tail lands on top of the start of the next
+    for (int loop = 0; loop < loopCount; ++loop) {
+        const int loopStart = static_cast<int>(std::round(loop * loopLengthInSamples));
+        const int numSamples = std::min(loopRenderLength, buffer.getNumSamples() - loopStart);
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
+            buffer.addFrom(channel, loopStart, loopBuffer, channel, 0, numSamples);
+        }
+    }
+}
@@ -11,15 +11,27 @@
 #pragma once
 #include <JuceHeader.h>
 #include "MIDIRenderer.h"
+#include "RenderedNoteCache.h"
 
 class AudioRenderer {
 public:
     
-    AudioRenderer(double sampleRate);
+    // with a noteCache, sequences whose notes never compete for voices are built from cached note renders instead of
+    // running the synth over the whole buffer
+    AudioRenderer(double sampleRate, RenderedNoteCache* noteCache = nullptr);
     
     
     void renderMIDISequence(juce::AudioBuffer<float>& buffer, juce::MidiMessageSequence* sequence, juce::Synthesiser* synth);
     
+    // For sequences made of loopCount identical loops: only the first loop (and its tail) is synthesised, then it's
+    // overlap-added at every loop start. Falls back to a full render when the loops differ. Voice allocation across a
+    // loop boundary isn't replayed, so note stealing between one loop's tails and the next loop can differ slightly.
+    void renderLoopedMIDISequence(juce::AudioBuffer<float>& buffer, juce::MidiMessageSequence* sequence, juce::Synthesiser* synth, double loopLengthInSamples, int loopCount);
+    
 private:
     double sampleRate;
+    RenderedNoteCache* noteCache;
+    
+    // false, with nothing written, when the sequence has to go through the synth after all
+    bool renderFromNoteCache(juce::AudioBuffer<float>& buffer, juce::MidiMessageSequence* sequence, juce::Synthesiser* synth);
 };
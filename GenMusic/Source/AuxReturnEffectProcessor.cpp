@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    AuxReturnEffectProcessor.cpp
+    Created: 19 Oct 2026 10:14:01am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "AuxReturnEffectProcessor.h"
+#include "Utilities.h"
+
+AuxReturnEffectProcessor::AuxReturnEffectProcessor(const RenderSettings& settings) : processor() {
+    juce::dsp::ProcessSpec spec;
+    spec.sampleRate = settings.sampleRate;
+    spec.maximumBlockSize = 1024;
+    spec.numChannels = 2;
+
+    processor.prepare(spec);
+
+    auto& chorus = processor.get<0>();
+
+    // juce::dsp::Chorus has no getters, so these are kept around for the configuration hash
+    const float chorusSettings[] = {0.9f, 0.2f, 7.0f, 0.0f, 1.0f};
+    chorus.setRate(chorusSettings[0]);
+    chorus.setDepth(chorusSettings[1]);
+    chorus.setCentreDelay(chorusSettings[2]);
+    chorus.setFeedback(chorusSettings[3]);
+    chorus.setMix(chorusSettings[4]);
+    // the chorus is the first thing to go for a preview, the reverb carries most of the character
+    processor.setBypassed<0>(settings.isPreview);
+
+    juce::dsp::Reverb::Parameters reverbParams;
+    reverbParams.roomSize = 0.7f; // Simulates a medium room
+    reverbParams.damping = 0.5f;  // Balanced high-frequency decay
+    reverbParams.wetLevel = 0.3f; // the busses' send levels decide how much of each one ends up here
+    reverbParams.dryLevel = 0.0f; // the dry signal reaches the mix through the busses themselves
+    reverbParams.width = 1.0f;    // Full stereo width for a spacious effect
+
+    processor.get<1>().setParameters(reverbParams);
+
+    if (!settings.impulseResponsePath.empty()) {
+        auto impulseResponse = settings.useSyntheticSamples ? ImpulseResponse::synthetic(settings.sampleRate) : ImpulseResponse::load(settings.impulseResponsePath, settings.sampleRate);
+        // the same wet level, the response is scaled to unit energy so it sits about where the algorithmic one did
+        convolution = std::make_unique<ConvolutionReverb>(std::move(impulseResponse), reverbParams.wetLevel);
+        processor.setBypassed<1>(true);
+    }
+
+    configurationHash = typeid(AuxReturnEffectProcessor).hash_code();
+    hashCombine(configurationHash, settings.sampleRate);
+    hashCombine(configurationHash, settings.isPreview);
+    for (auto value : chorusSettings) {
+        hashCombine(configurationHash, value);
+    }
+    for (auto value : {reverbParams.roomSize, reverbParams.damping, reverbParams.wetLevel, reverbParams.dryLevel, reverbParams.width, reverbParams.freezeMode}) {
+        hashCombine(configurationHash, value);
+    }
+    if (convolution != nullptr) {
+        hashCombine(configurationHash, convolution->getConfigurationHash());
+    }
+}
+
+void AuxReturnEffectProcessor::reset() {
+    processor.reset();
+    if (convolution != nullptr) {
+        convolution->reset();
+    }
+}
+
+void AuxReturnEffectProcessor::setRealtime(bool isRealtime) {
+    if (convolution != nullptr) {
+        convolution->setRealtime(isRealtime);
+    }
+}
+
+void AuxReturnEffectProcessor::process(juce::AudioBuffer<float>& buffer) {
+    const int maximumBlockSize = 1024;
+    int numSamples = buffer.getNumSamples();
+    for (int startSample = 0; startSample < numSamples; startSample += maximumBlockSize) {
+        const int blockSize = std::min(maximumBlockSize, numSamples - startSample);
+        juce::dsp::AudioBlock<float> block(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), startSample, blockSize);
+        juce::dsp::ProcessContextReplacing<float> context(block);
+        processor.process(context);
+    }
+    // the whole buffer at once, a render's worth is split across the convolution threads
+    if (convolution != nullptr) {
+        convolution->process(buffer);
+    }
+
+    logVerbose("Processed AuxReturnEffectProcessor");
+}
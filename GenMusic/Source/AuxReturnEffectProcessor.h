@@ -0,0 +1,31 @@
+/*
+  ==============================================================================
+
+    AuxReturnEffectProcessor.h
+    Created: 19 Oct 2026 10:14:01am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "EffectProcessor.h"
+#include "RenderSettings.h"
+#include "ConvolutionReverb.h"
+
+// The shared return every bus sends into: chorus then reverb, fully wet since the busses' dry signal is mixed in
+// separately. The reverb is a convolution with the settings' impulse response when there is one.
+class AuxReturnEffectProcessor : public EffectProcessor {
+public:
+    AuxReturnEffectProcessor(const RenderSettings& settings);
+
+    void process(juce::AudioBuffer<float>& buffer) override;
+    void reset() override;
+    void setRealtime(bool isRealtime) override;
+    std::size_t getConfigurationHash() const override { return configurationHash; }
+private:
+    juce::dsp::ProcessorChain<juce::dsp::Chorus<float>, juce::dsp::Reverb> processor;
+    // takes over from the chain's reverb, which is bypassed
+    std::unique_ptr<ConvolutionReverb> convolution;
+    std::size_t configurationHash = 0;
+};
@@ -0,0 +1,32 @@
+/*
+  ==============================================================================
+
+    BankedSampleProcessor.cpp
+    Created: 19 Oct 2026 9:36:18am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "BankedSampleProcessor.h"
+#include "Utilities.h"
+
+
+BankedSampleProcessor::BankedSampleProcessor(std::shared_ptr<SampleBank> bank, int instrument) : bank(bank), instrument(instrument) {
+
+}
+
+std::size_t BankedSampleProcessor::getIdentityHash() const {
+    auto hash = bank->getIdentityHash();
+    hashCombine(hash, instrument);
+    return hash;
+}
+
+juce::AudioBuffer<float> BankedSampleProcessor::getAudioForNoteNumber(int noteNumber) {
+    // banks are baked with every note the generators can play, playing a different one would change the song
+    if (!bank->hasAudio(instrument, noteNumber)) {
+        throw std::runtime_error("Note " + std::to_string(noteNumber) + " of instrument " + std::to_string(instrument) + " isn't in the sample bank");
+    }
+    // refers to the mapped data rather than copying it, the voice only ever reads from it
+    return bank->getAudio(instrument, noteNumber);
+}
@@ -0,0 +1,28 @@
+/*
+  ==============================================================================
+
+    BankedSampleProcessor.h
+    Created: 19 Oct 2026 9:36:18am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SampleProcessor.h"
+#include "SampleBank.h"
+
+// plays one instrument out of a baked SampleBank, nothing is decoded or repitched at runtime
+class BankedSampleProcessor : public SampleProcessor {
+public:
+
+    BankedSampleProcessor(std::shared_ptr<SampleBank> bank, int instrument);
+    juce::AudioBuffer<float> getAudioForNoteNumber(int noteNumber) override;
+    std::size_t getIdentityHash() const override;
+
+private:
+    std::shared_ptr<SampleBank> bank;
+    int instrument;
+};
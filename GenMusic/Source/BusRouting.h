@@ -0,0 +1,28 @@
+/*
+  ==============================================================================
+
+    BusRouting.h
+    Created: 19 Oct 2026 10:14:01am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <map>
+#include "EffectProcessor.h"
+
+// What each bus runs through and how much of it goes to the shared aux return. The return's time based effects are
+// processed once for the sum of every send, however many busses there are, and mixed in next to the dry busses.
+struct BusRouting {
+    std::map<int, EffectProcessor*> effects;
+    // linear send level per bus, a bus that isn't here doesn't send
+    std::map<int, float> sends;
+    // nullptr for no return, the sends are ignored then
+    EffectProcessor* auxReturn = nullptr;
+
+    float getSend(int bus) const {
+        auto it = sends.find(bus);
+        return it != sends.end() && auxReturn != nullptr ? it->second : 0.0f;
+    }
+};
@@ -11,32 +11,151 @@
 #pragma once
 
 #include "Note.h"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 #include <fmt/core.h>
 #include <fmt/format.h>
 
 class Note;
 
 enum ChordQuality {
-    Major, Minor, Diminished, Augmented, DominantSeventh, DominantThirteenth, MajorSeventh, MinorSeventh, HalfDiminishedSeventh, DiminishedSeventh, AugmentedSeventh, SusSecond, SusFourth, DominantSeventhSusFourth, DominantSeventhAltered, DominantThirteenthFlatNine, MinorMajorSeventh, MinorSixth
+    Major, Minor, Diminished, Augmented, DominantSeventh, DominantThirteenth, MajorSeventh, MinorSeventh, HalfDiminishedSeventh, DiminishedSeventh, AugmentedSeventh, SusSecond, SusFourth, DominantSeventhSusFourth, DominantSeventhAltered, DominantThirteenthFlatNine, MinorMajorSeventh, MinorSixth, ChordQualityCount
+};
+
+// every quality has eight choices, qualities nobody has written choices for yet are left undefined
+struct NoteChoices {
+    bool isDefined;
+    std::array<int, 8> intervals;
+    
+    constexpr std::size_t size() const { return intervals.size(); }
+    constexpr int operator[](std::size_t index) const { return intervals[index]; }
+    constexpr const int* begin() const { return intervals.data(); }
+    constexpr const int* end() const { return intervals.data() + intervals.size(); }
 };
 
 /*
-    The following map contains the intervals for each chord quality. These represent the valid notes for each
+    The following table contains the intervals for each chord quality. These represent the valid notes for each
     chord quality. They are also weighted so that the more "prominent" notes in a chord quality show up more.
  */
-const std::map<ChordQuality, std::vector<int>> noteChoicesForQuality = {
-    {Major, {0, 2, 2, 4, 4, 7, 7, 9}},
-    {Minor, {0, 3, 3, 5, 5, 7, 7, 10}},
-    {DominantSeventh, {0, 2, 2, 4, 4, 7, 7, 10}},
-    {DominantThirteenth, {0, 2, 2, 4, 4, 7, 7, 10}},
-    {MajorSeventh, {0, 2, 2, 4, 4, 7, 7, 11}},
-    {MinorSeventh, {0, 3, 3, 5, 5, 7, 7, 10}},
-    {MinorSixth, {0, 3, 3, 5, 5, 7, 9, 10}},
-    {SusFourth, {0, 5, 5, 7, 7, 10, 10, 12}},
-    {DominantSeventhSusFourth, {0, 5, 5, 7, 7, 10, 10, 12}},
-    {Diminished, {0, 3, 3, 6, 6, 9, 9, 12}},
+constexpr std::array<NoteChoices, ChordQualityCount> makeNoteChoicesTable() {
+    std::array<NoteChoices, ChordQualityCount> table {};
+    table[Major] = {true, {0, 2, 2, 4, 4, 7, 7, 9}};
+    table[Minor] = {true, {0, 3, 3, 5, 5, 7, 7, 10}};
+    table[DominantSeventh] = {true, {0, 2, 2, 4, 4, 7, 7, 10}};
+    table[DominantThirteenth] = {true, {0, 2, 2, 4, 4, 7, 7, 10}};
+    table[MajorSeventh] = {true, {0, 2, 2, 4, 4, 7, 7, 11}};
+    table[MinorSeventh] = {true, {0, 3, 3, 5, 5, 7, 7, 10}};
+    table[MinorSixth] = {true, {0, 3, 3, 5, 5, 7, 9, 10}};
+    table[SusFourth] = {true, {0, 5, 5, 7, 7, 10, 10, 12}};
+    table[DominantSeventhSusFourth] = {true, {0, 5, 5, 7, 7, 10, 10, 12}};
+    table[Diminished] = {true, {0, 3, 3, 6, 6, 9, 9, 12}};
+    return table;
+}
+
+constexpr auto noteChoicesForQuality = makeNoteChoicesTable();
+
+inline const NoteChoices& getNoteChoicesForQuality(ChordQuality quality) {
+    if (quality < 0 || quality >= ChordQualityCount || !noteChoicesForQuality[quality].isDefined) {
+        throw std::out_of_range("no note choices for chord quality");
+    }
+    return noteChoicesForQuality[quality];
+}
+
+/*
+    The nearest choices to a note only come from the two octaves either side of the root, so measured from the root
+    the candidates are the same for every root. For every distance from the root in range this holds the closest
+    candidate below and above it (as a distance from the root), NO_CANDIDATE when there isn't one.
+ */
+struct NearestChoiceTable {
+    static constexpr int LOWEST_OFFSET = -48;
+    static constexpr int HIGHEST_OFFSET = 127;
+    static constexpr int OCTAVES_EITHER_SIDE = 2;
+    static constexpr signed char NO_CANDIDATE = -128;
+    
+    std::array<signed char, HIGHEST_OFFSET - LOWEST_OFFSET + 1> below;
+    std::array<signed char, HIGHEST_OFFSET - LOWEST_OFFSET + 1> above;
+    
+    static constexpr bool contains(int offset) { return offset >= LOWEST_OFFSET && offset <= HIGHEST_OFFSET; }
 };
 
+constexpr int floorDivide(int value, int divisor) {
+    return value / divisor - (value % divisor != 0 && (value < 0) != (divisor < 0) ? 1 : 0);
+}
+
+constexpr NearestChoiceTable makeNearestChoiceTable(const NoteChoices& choices) {
+    NearestChoiceTable table {};
+    for (int offset = NearestChoiceTable::LOWEST_OFFSET; offset <= NearestChoiceTable::HIGHEST_OFFSET; ++offset) {
+        int below = NearestChoiceTable::NO_CANDIDATE;
+        int above = NearestChoiceTable::NO_CANDIDATE;
+        for (int interval : choices.intervals) {
+            // the highest octave of this interval still under the offset and the lowest one over it
+            const int belowOctave = std::min(floorDivide(offset - 1 - interval, 12), NearestChoiceTable::OCTAVES_EITHER_SIDE);
+            if (belowOctave >= -NearestChoiceTable::OCTAVES_EITHER_SIDE) {
+                const int candidate = interval + belowOctave * 12;
+                if (below == NearestChoiceTable::NO_CANDIDATE || candidate > below) {
+                    below = candidate;
+                }
+            }
+            const int aboveOctave = std::max(floorDivide(offset - interval, 12) + 1, -NearestChoiceTable::OCTAVES_EITHER_SIDE);
+            if (aboveOctave <= NearestChoiceTable::OCTAVES_EITHER_SIDE) {
+                const int candidate = interval + aboveOctave * 12;
+                if (above == NearestChoiceTable::NO_CANDIDATE || candidate < above) {
+                    above = candidate;
+                }
+            }
+        }
+        table.below[offset - NearestChoiceTable::LOWEST_OFFSET] = static_cast<signed char>(below);
+        table.above[offset - NearestChoiceTable::LOWEST_OFFSET] = static_cast<signed char>(above);
+    }
+    return table;
+}
+
+constexpr std::array<NearestChoiceTable, ChordQualityCount> makeNearestChoiceTables() {
+    std::array<NearestChoiceTable, ChordQualityCount> tables {};
+    for (int quality = 0; quality < ChordQualityCount; ++quality) {
+        tables[quality] = makeNearestChoiceTable(noteChoicesForQuality[quality]);
+    }
+    return tables;
+}
+
+constexpr auto nearestChoiceTables = makeNearestChoiceTables();
+
+/*
+    The closest notes below and above note, out of the quality's choices within two octaves of root. A side with
+    nothing on it (and a candidate below 0, which never counts) gives back the note itself.
+ */
+inline std::pair<int, int> nearestChoices(int note, int root, ChordQuality quality) {
+    const auto& choices = getNoteChoicesForQuality(quality);
+    const int offset = note - root;
+    
+    if (NearestChoiceTable::contains(offset)) {
+        const auto& table = nearestChoiceTables[quality];
+        const int below = table.below[offset - NearestChoiceTable::LOWEST_OFFSET];
+        const int above = table.above[offset - NearestChoiceTable::LOWEST_OFFSET];
+        return {below == NearestChoiceTable::NO_CANDIDATE || root + below < 0 ? note : root + below,
+                above == NearestChoiceTable::NO_CANDIDATE ? note : root + above};
+    }
+    
+    // far outside any range the generators use, just scan
+    int nearestBelow = -1;
+    int nearestAbove = 1000;
+    for (int interval : choices) {
+        for (int octave = -NearestChoiceTable::OCTAVES_EITHER_SIDE; octave <= NearestChoiceTable::OCTAVES_EITHER_SIDE; ++octave) {
+            const int currentNote = root + interval + octave * 12;
+            if (currentNote < note && currentNote > nearestBelow) {
+                nearestBelow = currentNote;
+            }
+            if (currentNote > note && currentNote < nearestAbove) {
+                nearestAbove = currentNote;
+            }
+        }
+    }
+    return {nearestBelow == -1 ? note : nearestBelow, nearestAbove == 1000 ? note : nearestAbove};
+}
+
 class Chord {
 public:
     
@@ -55,8 +174,8 @@ public:
     
     ChordQuality getQuality() const { return quality; }
     
-    std::vector<int> getNoteChoices() const {
-        return noteChoicesForQuality.at(quality);
+    const NoteChoices& getNoteChoices() const {
+        return getNoteChoicesForQuality(quality);
     }
     
 private:
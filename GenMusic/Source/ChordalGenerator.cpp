@@ -9,6 +9,66 @@
 */
 
 #include "ChordalGenerator.h"
+#include <initializer_list>
+
+// the chord built on a degree of the scale, tables of them are indexed by the degree's distance from the key
+struct DiatonicChord {
+    ChordQuality quality;
+    std::array<int, 4> intervals;
+    int intervalCount;
+    bool exists;
+};
+
+using DiatonicChordTable = std::array<DiatonicChord, 12>;
+
+static constexpr DiatonicChordTable makeDiatonicChordTable(std::initializer_list<std::pair<int, DiatonicChord>> chords) {
+    DiatonicChordTable table {};
+    for (const auto& chord : chords) {
+        table[chord.first] = chord.second;
+        table[chord.first].exists = true;
+    }
+    return table;
+}
+
+static constexpr DiatonicChordTable diatonicMajorChords = makeDiatonicChordTable({
+    {0, {Major, {0, 16, 7}, 3}}, // root major
+    {2, {Minor, {0, 15, 7}, 3}}, // minor second
+    {4, {Minor, {0, 15, 7}, 3}}, // minor third
+    {5, {Major, {0, 16, 7}, 3}}, // major fourth
+    {7, {DominantSeventh, {0, 16, 10}, 3}}, // dominant7 fifth
+    {9, {MinorSixth, {0, 15, 7, 10}, 4}}, // minor6 sixth
+    {11, {DominantSeventhSusFourth, {0, 17, 10}, 3}}, // dominant7sus4 seventh
+});
+
+static constexpr DiatonicChordTable diatonicMinorChords = makeDiatonicChordTable({
+    {0, {Minor, {0, 15, 7}, 3}}, // root minor
+    {2, {Minor, {0, 15, 7}, 3}}, // minor second
+    {3, {Major, {0, 16, 7}, 3}}, // major third
+    {5, {Minor, {0, 15, 7}, 3}}, // minor fourth
+    {7, {DominantSeventh, {0, 16, 10}, 3}}, // dominant7 fifth
+    {10, {MajorSeventh, {0, 16, 7, 11}, 4}}, // major7 seventh
+    {11, {MajorSeventh, {0, 16, 7}, 3}}, // major major seventh
+});
+
+static constexpr DiatonicChordTable diatonicMajorTransitionChords = makeDiatonicChordTable({
+    {0, {SusFourth, {0, 17, 7}, 3}}, // root sus4
+    {2, {Minor, {0, 15, 7}, 3}}, // minor second
+    {4, {DominantSeventh, {0, 16, 10}, 3}}, // dominant7 third
+    {5, {MinorSixth, {0, 10, 15, 19}, 4}}, // minor6 fourth
+    {7, {DominantSeventh, {0, 16, 10}, 3}}, // dominant7 fifth
+    {9, {Minor, {0, 15, 7, 10}, 4}}, // minor sixth
+    {11, {DominantSeventhSusFourth, {0, 17, 10}, 3}}, // dominant7sus4 seventh
+});
+
+static constexpr DiatonicChordTable diatonicMinorTransitionChords = makeDiatonicChordTable({
+    {0, {Minor, {0, 15, 7, 11}, 4}}, // root minor
+    {2, {Minor, {0, 15, 7}, 3}}, // minor second
+    {3, {Major, {0, 16, 7, 11}, 4}}, // major7 third
+    {5, {MinorSixth, {0, 10, 15, 19}, 4}}, // minor6 fourth
+    {7, {DominantSeventh, {0, 16, 10}, 3}}, // dominant7 fifth
+    {10, {DominantThirteenth, {0, 16, 10, 21}, 4}}, // dominant13 seventh
+    {11, {Major, {0, 16, 7}, 3}}, // major major seventh
+});
 
 
 ChordalGenerator::ChordalGenerator(const std::vector<unsigned char> seed, bool isMajor) : seed(seed), isMajor(isMajor) {
@@ -28,38 +88,68 @@ std::vector<Note> ChordalGenerator::generate() {
     return allChordNotes;
 }
 
+std::vector<Note> ChordalGenerator::generatePhrase(int phraseIndex, double phraseStartBeat) {
+    std::vector<Note> notes;
+    for (const auto& chord: getChordsForLoop(getRoots(), phraseStartBeat)) {
+        for (const auto& note: chord.getNotes()) {
+            notes.push_back(note);
+        }
+    }
+    return notes;
+}
+
 std::vector<Chord> ChordalGenerator::getChords(const std::vector<int> roots) {
     std::vector<Chord> result;
+    for (int l = 0; l < LOOPS; l++) {
+        for (const auto& chord : getChordsForLoop(roots, l * PHRASE_LENGTH_IN_BEATS)) {
+            result.push_back(chord);
+        }
+    }
+    return result;
+}
+
+std::vector<Chord> ChordalGenerator::getChordsForLoop(const std::vector<int>& roots, double loopStartBeat) {
+    std::vector<Chord> result;
     
     // The first root is the key of the loop and the first chord will be in the relative diatonic chord pattern of position 0.
     // For every other chord it will be the relative diatonic pattern relative to the key
     
     const auto& root = roots[0];
-    for (int l = 0; l < LOOPS; l++) {
-        for (int i = 0; i < roots.size(); i++) {
-            const auto& currentRoot = roots[i];
-            auto relativeRoot = currentRoot - root;
-            if (relativeRoot < 0) {
-                relativeRoot += 12;
-            }
-            if (relativeRoot > 11) {
-                relativeRoot -= 12;
-            }
-            
-            const auto& chord = isMajor ?
-            (i + 1 == roots.size()) ? diatonicMajorTransitionChordPatterns.at(relativeRoot) : diatonicMajorChordPatterns.at(relativeRoot) : (i + 1 == roots.size()) ? diatonicMinorTransitionChordPatterns.at(relativeRoot) : diatonicMinorChordPatterns.at(relativeRoot);
-            
-            const auto chordQuality = isMajor ? (i + 1 == roots.size()) ? diatonicMajorTransitionChordQualities.at(relativeRoot) : diatonicMajorChordQualities.at(relativeRoot) : (i + 1 == roots.size()) ? diatonicMinorTransitionChordQualities.at(relativeRoot) : diatonicMinorChordQualities.at(relativeRoot);
-            
-            Note initial = Note(LOW_C+currentRoot, (l*16) + i*4.0, 4.0);
-            
-            result.push_back(Chord(Note(LOW_C+currentRoot, (l*16) + i*4.0, 4.0), chordQuality, chord));
+    for (int i = 0; i < roots.size(); i++) {
+        const auto& currentRoot = roots[i];
+        auto relativeRoot = currentRoot - root;
+        if (relativeRoot < 0) {
+            relativeRoot += 12;
         }
+        if (relativeRoot > 11) {
+            relativeRoot -= 12;
+        }
+        
+        const bool isTransition = i + 1 == roots.size();
+        const auto& table = isMajor ? (isTransition ? diatonicMajorTransitionChords : diatonicMajorChords) : (isTransition ? diatonicMinorTransitionChords : diatonicMinorChords);
+        const auto& chord = table.at(relativeRoot);
+        if (!chord.exists) {
+            throw std::out_of_range("no diatonic chord on that degree");
+        }
+        
+        result.push_back(Chord(Note(LOW_C+currentRoot, loopStartBeat + i*4.0, 4.0), chord.quality, std::vector<int>(chord.intervals.begin(), chord.intervals.begin() + chord.intervalCount)));
     }
     
     return result;
 }
 
+std::pair<int, int> ChordalGenerator::getNoteRange() {
+    int widest = 0;
+    for (const auto* table : {&diatonicMajorChords, &diatonicMinorChords, &diatonicMajorTransitionChords, &diatonicMinorTransitionChords}) {
+        for (const auto& chord : *table) {
+            for (int i = 0; i < chord.intervalCount; ++i) {
+                widest = std::max(widest, chord.intervals[i]);
+            }
+        }
+    }
+    return {LOW_C, LOW_C + HIGHEST_ROOT + widest};
+}
+
 std::vector<int> ChordalGenerator::getRoots() {
     std::vector<int> resultIntervals;
     
@@ -0,0 +1,38 @@
+/*
+  ==============================================================================
+
+    CompactAudioBuffer.cpp
+    Created: 19 Oct 2026 10:20:35am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "CompactAudioBuffer.h"
+#include "DSPKernels.h"
+
+CompactAudioBuffer::CompactAudioBuffer(const juce::AudioBuffer<float>& audio) : numChannels(audio.getNumChannels()), numSamples(audio.getNumSamples()), samples(static_cast<size_t>(numChannels) * static_cast<size_t>(numSamples)), scales(static_cast<size_t>(numChannels)) {
+    for (int channel = 0; channel < numChannels; ++channel) {
+        const auto peak = audio.getMagnitude(channel, 0, numSamples);
+        // a silent channel stays all zeroes with a zero scale
+        scales[channel] = peak / 32767.0f;
+        const auto toInteger = peak > 0.0f ? 32767.0f / peak : 0.0f;
+
+        auto* destination = samples.data() + static_cast<size_t>(channel) * static_cast<size_t>(numSamples);
+        DSPKernels::get().floatToInt16(destination, audio.getReadPointer(channel), toInteger, numSamples);
+    }
+}
+
+void CompactAudioBuffer::read(int channel, int startSample, float* destination, int numSamplesToRead) const {
+    jassert(channel >= 0 && channel < numChannels && startSample >= 0 && startSample + numSamplesToRead <= numSamples);
+    const auto* source = samples.data() + static_cast<size_t>(channel) * static_cast<size_t>(numSamples) + startSample;
+    DSPKernels::get().int16ToFloat(destination, source, scales[static_cast<size_t>(channel)], numSamplesToRead);
+}
+
+juce::AudioBuffer<float> CompactAudioBuffer::toFloat() const {
+    juce::AudioBuffer<float> audio(numChannels, numSamples);
+    for (int channel = 0; channel < numChannels; ++channel) {
+        read(channel, 0, audio.getWritePointer(channel), numSamples);
+    }
+    return audio;
+}
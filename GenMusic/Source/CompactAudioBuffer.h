@@ -0,0 +1,39 @@
+/*
+  ==============================================================================
+
+    CompactAudioBuffer.h
+    Created: 19 Oct 2026 10:20:35am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <cstdint>
+#include <vector>
+
+/*
+    Sample audio in half the memory of a float buffer: 16 bit samples with a scale per channel, so a quiet recording
+    keeps all of its resolution. It never changes once built, voices share one and convert just the chunk they're
+    mixing back to float.
+ */
+class CompactAudioBuffer {
+public:
+    explicit CompactAudioBuffer(const juce::AudioBuffer<float>& audio);
+
+    int getNumChannels() const { return numChannels; }
+    int getNumSamples() const { return numSamples; }
+    std::size_t getSizeInBytes() const { return samples.size() * sizeof(std::int16_t); }
+
+    // numSamplesToRead samples of channel from startSample, as float. Doesn't allocate, voices call it while mixing
+    void read(int channel, int startSample, float* destination, int numSamplesToRead) const;
+    juce::AudioBuffer<float> toFloat() const;
+
+private:
+    int numChannels;
+    int numSamples;
+    // channel after channel
+    std::vector<std::int16_t> samples;
+    std::vector<float> scales;
+};
@@ -0,0 +1,358 @@
+/*
+  ==============================================================================
+
+    ConvolutionReverb.cpp
+    Created: 19 Oct 2026 10:41:43am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "ConvolutionReverb.h"
+#include <algorithm>
+#include <atomic>
+#include "DSPKernels.h"
+#include "Utilities.h"
+
+// the parts run a slice of the buffer at a time, a buffer at least this long has them on the convolution threads
+const int SLICE_SIZE = 65536;
+// the direct taps are applied this many samples at a time
+const int DIRECT_BLOCK_SIZE = 1024;
+
+// a segment's partitions are split into a job for every this many
+const int PARTITIONS_PER_JOB = 8;
+
+// separate from the mix graph's pool, a bus node waits here for its parts and would otherwise be waiting on itself
+static juce::ThreadPool& getConvolutionPool() {
+    static juce::ThreadPool pool(juce::SystemStats::getNumCpus());
+    return pool;
+}
+
+// and a part waits here for its partition sums
+static juce::ThreadPool& getPartitionPool() {
+    static juce::ThreadPool pool(juce::SystemStats::getNumCpus());
+    return pool;
+}
+
+class ConvolutionReverb::Part {
+public:
+    virtual ~Part() = default;
+    virtual void process(const float* input, float* output, int numSamples) = 0;
+    virtual void reset() = 0;
+    virtual void setRealtime(bool) {}
+};
+
+class ConvolutionReverb::DirectPart : public Part {
+public:
+    DirectPart(const float* taps, int numTaps) : taps(taps), numTaps(numTaps), input(static_cast<size_t>(numTaps - 1 + DIRECT_BLOCK_SIZE)) {
+
+    }
+
+    void process(const float* source, float* output, int numSamples) override {
+        const auto& kernels = DSPKernels::get();
+        const auto history = numTaps - 1;
+        for (int start = 0; start < numSamples; start += DIRECT_BLOCK_SIZE) {
+            const auto blockSize = std::min(DIRECT_BLOCK_SIZE, numSamples - start);
+            // the last history samples of input, then the block
+            std::copy(source + start, source + start + blockSize, input.begin() + history);
+            for (int tap = 0; tap < numTaps; ++tap) {
+                kernels.addScaled(output + start, input.data() + history - tap, taps[tap], blockSize);
+            }
+            std::copy(input.begin() + blockSize, input.begin() + blockSize + history, input.begin());
+        }
+    }
+
+    void reset() override {
+        std::fill(input.begin(), input.end(), 0.0f);
+    }
+
+private:
+    const float* taps;
+    int numTaps;
+    std::vector<float> input;
+};
+
+class ConvolutionReverb::PartitionedPart : public Part, private juce::Thread {
+public:
+    PartitionedPart(const ImpulseResponse::Segment& segment, int channel) :
+        juce::Thread("Convolution tail"),
+        size(segment.partitionSize),
+        numBins(segment.partitionSize + 1),
+        firstPartition(segment.firstPartition),
+        numPartitions(segment.numPartitions),
+        spectra(segment.spectra[static_cast<size_t>(channel)].data()),
+        fft(juce::findHighestSetBit(static_cast<juce::uint32>(segment.partitionSize * 2))),
+        window(static_cast<size_t>(size) * 2),
+        // only partitions from firstPartition - 1 blocks ago onwards are ever used
+        history(static_cast<size_t>((firstPartition + numPartitions - 1) * numBins * 2)),
+        transform(static_cast<size_t>(size) * 4),
+        sum(static_cast<size_t>(numBins) * 2),
+        blockOutput(static_cast<size_t>(size)),
+        behindWindow(static_cast<size_t>(size) * 2),
+        behindOutput(static_cast<size_t>(size)) {
+        jassert(firstPartition >= 1);
+        const auto numJobs = std::clamp(numPartitions / PARTITIONS_PER_JOB, 1, juce::SystemStats::getNumCpus());
+        partialSums.resize(static_cast<size_t>(numJobs - 1), std::vector<float>(static_cast<size_t>(numBins) * 2));
+    }
+
+    ~PartitionedPart() override {
+        setRealtime(false);
+    }
+
+    void process(const float* input, float* output, int numSamples) override {
+        const auto& kernels = DSPKernels::get();
+        while (numSamples > 0) {
+            const auto count = std::min(numSamples, size - filled);
+            std::copy(input, input + count, window.begin() + size + filled);
+            kernels.addScaled(output, blockOutput.data() + filled, 1.0f, count);
+            filled += count;
+            input += count;
+            output += count;
+            numSamples -= count;
+            if (filled == size) {
+                finishBlock();
+            }
+        }
+    }
+
+    void reset() override {
+        // the worker has to be done with its block before it's cleared from under it
+        if (behind) {
+            workDone.wait();
+        }
+        for (auto* values : {&window, &history, &blockOutput, &behindWindow, &behindOutput}) {
+            std::fill(values->begin(), values->end(), 0.0f);
+        }
+        filled = 0;
+        newest = 0;
+        if (behind) {
+            workDone.signal();
+        }
+    }
+
+    void setRealtime(bool isRealtime) override {
+        realtime = isRealtime;
+        // a segment starting two partitions in has a block to spare, so it can be worked out a block behind
+        const auto shouldRunBehind = isRealtime && firstPartition >= 2;
+        if (shouldRunBehind == behind) {
+            return;
+        }
+        if (shouldRunBehind) {
+            // nothing's been handed over yet, the first block's output is silence
+            workDone.signal();
+            startThread(juce::Thread::Priority::high);
+        } else {
+            workDone.wait();
+            signalThreadShouldExit();
+            workReady.signal();
+            stopThread(-1);
+        }
+        behind = shouldRunBehind;
+    }
+
+private:
+    // the block just read in is transformed into the history, and the next block's output worked out from it
+    void finishBlock() {
+        if (behind) {
+            // the worker has had this whole block to work out the next one's output, from the blocks before it
+            workDone.wait();
+            std::copy(behindOutput.begin(), behindOutput.end(), blockOutput.begin());
+            std::copy(window.begin(), window.end(), behindWindow.begin());
+            workReady.signal();
+        } else {
+            transformIntoHistory(window);
+            // an audio callback's thread can't wait on the partition pool
+            accumulate(firstPartition - 1, !realtime);
+            inverseInto(blockOutput);
+        }
+
+        std::copy(window.begin() + size, window.end(), window.begin());
+        filled = 0;
+    }
+
+    // runs a block behind finishBlock, the output it works out is for the block after the one being filled
+    void run() override {
+        for (;;) {
+            workReady.wait();
+            if (threadShouldExit()) {
+                return;
+            }
+            transformIntoHistory(behindWindow);
+            accumulate(firstPartition - 2, true);
+            inverseInto(behindOutput);
+            workDone.signal();
+        }
+    }
+
+    // overlap-save, the block with the one before it
+    void transformIntoHistory(const std::vector<float>& blocks) {
+        const auto historyLength = firstPartition + numPartitions - 1;
+        std::copy(blocks.begin(), blocks.end(), transform.begin());
+        std::fill(transform.begin() + size * 2, transform.end(), 0.0f);
+        fft.performRealOnlyForwardTransform(transform.data(), true);
+        newest = (newest + 1) % historyLength;
+        std::copy(transform.begin(), transform.begin() + numBins * 2, history.begin() + newest * numBins * 2);
+    }
+
+    // sums partition p times the block read in ageOffset + p blocks before the newest one. Split between jobs that
+    // each sum their share of the partitions into their own spectrum, added together once they've all finished
+    void accumulate(int ageOffset, bool maySplit) {
+        const auto& kernels = DSPKernels::get();
+        const auto historyLength = firstPartition + numPartitions - 1;
+        auto sumPartitions = [&](float* destination, int begin, int end) {
+            std::fill(destination, destination + numBins * 2, 0.0f);
+            for (int partition = begin; partition < end; ++partition) {
+                const auto slot = (newest - ageOffset - partition + historyLength) % historyLength;
+                kernels.complexMultiplyAdd(destination, history.data() + slot * numBins * 2, spectra + partition * numBins * 2, numBins);
+            }
+        };
+
+        const auto numJobs = maySplit ? static_cast<int>(partialSums.size()) + 1 : 1;
+        if (numJobs == 1) {
+            sumPartitions(sum.data(), 0, numPartitions);
+            return;
+        }
+        std::atomic<int> remaining { numJobs - 1 };
+        juce::WaitableEvent finished;
+        for (int job = 1; job < numJobs; ++job) {
+            getPartitionPool().addJob([&, job]() {
+                sumPartitions(partialSums[static_cast<size_t>(job - 1)].data(), job * numPartitions / numJobs, (job + 1) * numPartitions / numJobs);
+                if (--remaining == 0) {
+                    finished.signal();
+                }
+                return juce::ThreadPoolJob::jobHasFinished;
+            });
+        }
+        // the first share is summed here rather than waiting idle
+        sumPartitions(sum.data(), 0, numPartitions / numJobs);
+        finished.wait();
+        for (const auto& partialSum : partialSums) {
+            kernels.addScaled(sum.data(), partialSum.data(), 1.0f, numBins * 2);
+        }
+    }
+
+    void inverseInto(std::vector<float>& output) {
+        std::copy(sum.begin(), sum.end(), transform.begin());
+        std::fill(transform.begin() + numBins * 2, transform.end(), 0.0f);
+        fft.performRealOnlyInverseTransform(transform.data());
+        // the first half wrapped around, the second is the linear convolution
+        std::copy(transform.begin() + size, transform.begin() + size * 2, output.begin());
+    }
+
+    int size;
+    int numBins;
+    int firstPartition;
+    int numPartitions;
+    // owned by the impulse response
+    const float* spectra;
+    juce::dsp::FFT fft;
+    // the last block read in, then the one being filled
+    std::vector<float> window;
+    int filled = 0;
+    // spectra of the blocks read in, newest is the last one
+    std::vector<float> history;
+    int newest = 0;
+    std::vector<float> transform;
+    std::vector<float> sum;
+    // one per job after the first, which sums into sum
+    std::vector<std::vector<float>> partialSums;
+    // the output for the block being filled, worked out when the last one finished
+    std::vector<float> blockOutput;
+
+    bool realtime = false;
+    // in realtime finishBlock hands the window over to run, which works out the output behindOutput holds
+    bool behind = false;
+    std::vector<float> behindWindow;
+    std::vector<float> behindOutput;
+    juce::WaitableEvent workReady;
+    juce::WaitableEvent workDone;
+};
+
+ConvolutionReverb::ConvolutionReverb(std::shared_ptr<const ImpulseResponse> impulseResponse, float wetLevel) : impulseResponse(std::move(impulseResponse)), wetLevel(wetLevel) {
+    if (this->impulseResponse == nullptr) {
+        throw std::invalid_argument("A convolution reverb needs an impulse response");
+    }
+    // the buses and returns are stereo, anything else is set up the first time it's seen
+    prepare(2);
+
+    configurationHash = typeid(ConvolutionReverb).hash_code();
+    hashCombine(configurationHash, this->impulseResponse->getIdentity());
+    hashCombine(configurationHash, wetLevel);
+}
+
+ConvolutionReverb::~ConvolutionReverb() = default;
+
+void ConvolutionReverb::prepare(int numChannels) {
+    if (numChannels == preparedChannels) {
+        return;
+    }
+    preparedChannels = numChannels;
+
+    parts.clear();
+    partChannels.clear();
+    for (int channel = 0; channel < numChannels; ++channel) {
+        // a mono response is used for both sides
+        const auto responseChannel = std::min(channel, impulseResponse->getNumChannels() - 1);
+        parts.push_back(std::make_unique<DirectPart>(impulseResponse->getDirectTaps(responseChannel), impulseResponse->getNumDirectTaps()));
+        partChannels.push_back(channel);
+        for (const auto& segment : impulseResponse->getSegments()) {
+            parts.push_back(std::make_unique<PartitionedPart>(segment, responseChannel));
+            partChannels.push_back(channel);
+        }
+    }
+    partOutputs.setSize(static_cast<int>(parts.size()), SLICE_SIZE);
+    setRealtime(realtime);
+}
+
+void ConvolutionReverb::reset() {
+    for (auto& part : parts) {
+        part->reset();
+    }
+}
+
+void ConvolutionReverb::setRealtime(bool isRealtime) {
+    realtime = isRealtime;
+    for (auto& part : parts) {
+        part->setRealtime(isRealtime);
+    }
+    reset();
+}
+
+void ConvolutionReverb::process(juce::AudioBuffer<float>& buffer) {
+    prepare(buffer.getNumChannels());
+    const auto& kernels = DSPKernels::get();
+    const auto numSamples = buffer.getNumSamples();
+
+    for (int start = 0; start < numSamples; start += SLICE_SIZE) {
+        const auto sliceSize = std::min(SLICE_SIZE, numSamples - start);
+        partOutputs.clear(0, sliceSize);
+        auto runPart = [&](size_t part) {
+            parts[part]->process(buffer.getReadPointer(partChannels[part], start), partOutputs.getWritePointer(static_cast<int>(part)), sliceSize);
+        };
+
+        if (sliceSize == SLICE_SIZE) {
+            std::atomic<size_t> remaining { parts.size() };
+            juce::WaitableEvent finished;
+            for (size_t part = 0; part < parts.size(); ++part) {
+                getConvolutionPool().addJob([&, part]() {
+                    runPart(part);
+                    if (--remaining == 0) {
+                        finished.signal();
+                    }
+                    return juce::ThreadPoolJob::jobHasFinished;
+                });
+            }
+            finished.wait();
+        } else {
+            for (size_t part = 0; part < parts.size(); ++part) {
+                runPart(part);
+            }
+        }
+
+        // every part has read the slice, it can be replaced with the wet signal now
+        buffer.clear(start, sliceSize);
+        for (size_t part = 0; part < parts.size(); ++part) {
+            kernels.addScaled(buffer.getWritePointer(partChannels[part], start), partOutputs.getReadPointer(static_cast<int>(part)), wetLevel, sliceSize);
+        }
+    }
+}
@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    ConvolutionReverb.h
+    Created: 19 Oct 2026 10:41:43am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <memory>
+#include <vector>
+#include "EffectProcessor.h"
+#include "ImpulseResponse.h"
+
+/*
+    Convolves each channel with the matching channel of an impulse response (a mono response is used for both), fully
+    wet at wetLevel. Non-uniformly partitioned: the response's first taps are convolved directly so nothing comes out
+    late, and each of its segments is a uniformly partitioned overlap-save convolution at that segment's own block
+    length. Because a segment starts one of its partitions into the response, a block's contribution isn't due until
+    the block has been read in, so the long tail partitions cost one FFT per few thousand samples and no latency.
+
+    The direct taps and segments share no state, so an offline render's buffer has every channel's taps and segments
+    convolved on threads of their own a slice at a time, summed once they've all finished the slice. Anything shorter
+    than a slice, like an audio callback's block, is convolved on the calling thread. A segment with enough partitions
+    splits them between jobs too, each summing its share into a spectrum of its own.
+
+    In realtime the longest segment, which starts two partitions in, is worked out a block ahead on a thread of its
+    own, so the callback that finishes one of its blocks only hands the block over instead of doing the FFTs and the
+    whole tail's multiplies itself.
+ */
+class ConvolutionReverb : public EffectProcessor {
+public:
+    ConvolutionReverb(std::shared_ptr<const ImpulseResponse> impulseResponse, float wetLevel);
+    ~ConvolutionReverb() override;
+
+    void process(juce::AudioBuffer<float>& buffer) override;
+    void reset() override;
+    void setRealtime(bool isRealtime) override;
+    std::size_t getConfigurationHash() const override { return configurationHash; }
+
+private:
+    // the direct taps or one segment for one channel, adds its share of the output
+    class Part;
+    class DirectPart;
+    class PartitionedPart;
+
+    void prepare(int numChannels);
+
+    std::shared_ptr<const ImpulseResponse> impulseResponse;
+    float wetLevel;
+    std::vector<std::unique_ptr<Part>> parts;
+    // which channel each part convolves
+    std::vector<int> partChannels;
+    int preparedChannels = 0;
+    bool realtime = false;
+    // a slice of output per part, summed into the buffer once every part has run
+    juce::AudioBuffer<float> partOutputs;
+    std::size_t configurationHash = 0;
+};
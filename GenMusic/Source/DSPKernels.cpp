@@ -0,0 +1,458 @@
+/*
+  ==============================================================================
+
+    DSPKernels.cpp
+    Created: 19 Oct 2026 10:26:31am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "DSPKernels.h"
+#include <JuceHeader.h>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+ #define GENMUSIC_KERNELS_X86 1
+ #include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+ #define GENMUSIC_KERNELS_NEON 1
+ #include <arm_neon.h>
+#endif
+
+// the wider sets are compiled per function so the rest of the build doesn't have to assume them
+#if defined(__GNUC__) || defined(__clang__)
+ #define GENMUSIC_TARGET(isa) __attribute__((target(isa)))
+#else
+ #define GENMUSIC_TARGET(isa)
+#endif
+
+//==============================================================================
+// plain C++, also finishes off whatever the vector versions leave over
+
+static void scalarApplyGainRamp(float* samples, float startGain, float endGain, int numSamples) {
+    const auto increment = (endGain - startGain) / static_cast<float>(numSamples);
+    for (int i = 0; i < numSamples; ++i) {
+        samples[i] *= startGain + increment * static_cast<float>(i);
+    }
+}
+
+static void scalarMultiplyAdd(float* destination, const float* source, const float* envelope, int numSamples) {
+    for (int i = 0; i < numSamples; ++i) {
+        destination[i] += source[i] * envelope[i];
+    }
+}
+
+static void scalarAddScaled(float* destination, const float* source, float gain, int numSamples) {
+    for (int i = 0; i < numSamples; ++i) {
+        destination[i] += source[i] * gain;
+    }
+}
+
+static void scalarStereoMatrix(float* left, float* right, float leftFromLeft, float leftFromRight, float rightFromLeft, float rightFromRight, int numSamples) {
+    for (int i = 0; i < numSamples; ++i) {
+        const auto l = left[i];
+        const auto r = right[i];
+        left[i] = l * leftFromLeft + r * leftFromRight;
+        right[i] = l * rightFromLeft + r * rightFromRight;
+    }
+}
+
+static void scalarComplexMultiplyAdd(float* destination, const float* a, const float* b, int numComplex) {
+    for (int i = 0; i < numComplex * 2; i += 2) {
+        destination[i] += a[i] * b[i] - a[i + 1] * b[i + 1];
+        destination[i + 1] += a[i] * b[i + 1] + a[i + 1] * b[i];
+    }
+}
+
+static void scalarInt16ToFloat(float* destination, const std::int16_t* source, float scale, int numSamples) {
+    for (int i = 0; i < numSamples; ++i) {
+        destination[i] = static_cast<float>(source[i]) * scale;
+    }
+}
+
+static void scalarFloatToInt16(std::int16_t* destination, const float* source, float scale, int numSamples) {
+    for (int i = 0; i < numSamples; ++i) {
+        destination[i] = static_cast<std::int16_t>(std::lrint(std::clamp(source[i] * scale, -32767.0f, 32767.0f)));
+    }
+}
+
+#if GENMUSIC_KERNELS_X86
+//==============================================================================
+// SSE2, four at a time
+
+GENMUSIC_TARGET("sse2") static void sse2ApplyGainRamp(float* samples, float startGain, float endGain, int numSamples) {
+    const auto increment = (endGain - startGain) / static_cast<float>(numSamples);
+    const auto ramp = _mm_add_ps(_mm_set1_ps(startGain), _mm_mul_ps(_mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f), _mm_set1_ps(increment)));
+    int i = 0;
+    // offset from the index each time rather than accumulated, so long ramps don't drift
+    for (; i + 4 <= numSamples; i += 4) {
+        const auto gains = _mm_add_ps(ramp, _mm_set1_ps(increment * static_cast<float>(i)));
+        _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), gains));
+    }
+    for (; i < numSamples; ++i) {
+        samples[i] *= startGain + increment * static_cast<float>(i);
+    }
+}
+
+GENMUSIC_TARGET("sse2") static void sse2MultiplyAdd(float* destination, const float* source, const float* envelope, int numSamples) {
+    int i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        const auto product = _mm_mul_ps(_mm_loadu_ps(source + i), _mm_loadu_ps(envelope + i));
+        _mm_storeu_ps(destination + i, _mm_add_ps(_mm_loadu_ps(destination + i), product));
+    }
+    scalarMultiplyAdd(destination + i, source + i, envelope + i, numSamples - i);
+}
+
+GENMUSIC_TARGET("sse2") static void sse2AddScaled(float* destination, const float* source, float gain, int numSamples) {
+    const auto gains = _mm_set1_ps(gain);
+    int i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        _mm_storeu_ps(destination + i, _mm_add_ps(_mm_loadu_ps(destination + i), _mm_mul_ps(_mm_loadu_ps(source + i), gains)));
+    }
+    scalarAddScaled(destination + i, source + i, gain, numSamples - i);
+}
+
+GENMUSIC_TARGET("sse2") static void sse2StereoMatrix(float* left, float* right, float leftFromLeft, float leftFromRight, float rightFromLeft, float rightFromRight, int numSamples) {
+    const auto ll = _mm_set1_ps(leftFromLeft);
+    const auto lr = _mm_set1_ps(leftFromRight);
+    const auto rl = _mm_set1_ps(rightFromLeft);
+    const auto rr = _mm_set1_ps(rightFromRight);
+    int i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        const auto l = _mm_loadu_ps(left + i);
+        const auto r = _mm_loadu_ps(right + i);
+        _mm_storeu_ps(left + i, _mm_add_ps(_mm_mul_ps(l, ll), _mm_mul_ps(r, lr)));
+        _mm_storeu_ps(right + i, _mm_add_ps(_mm_mul_ps(l, rl), _mm_mul_ps(r, rr)));
+    }
+    scalarStereoMatrix(left + i, right + i, leftFromLeft, leftFromRight, rightFromLeft, rightFromRight, numSamples - i);
+}
+
+GENMUSIC_TARGET("sse2") static void sse2ComplexMultiplyAdd(float* destination, const float* a, const float* b, int numComplex) {
+    // no addsub before SSE3, the imaginary products are swapped into place and the real ones negated with a sign flip
+    const auto negateReal = _mm_castsi128_ps(_mm_set_epi32(0, static_cast<int>(0x80000000), 0, static_cast<int>(0x80000000)));
+    int i = 0;
+    for (; i + 2 <= numComplex; i += 2) {
+        const auto x = _mm_loadu_ps(a + i * 2);
+        const auto y = _mm_loadu_ps(b + i * 2);
+        const auto real = _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 2, 0, 0));
+        const auto imaginary = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 1, 1));
+        const auto swapped = _mm_shuffle_ps(y, y, _MM_SHUFFLE(2, 3, 0, 1));
+        const auto product = _mm_add_ps(_mm_mul_ps(real, y), _mm_xor_ps(_mm_mul_ps(imaginary, swapped), negateReal));
+        _mm_storeu_ps(destination + i * 2, _mm_add_ps(_mm_loadu_ps(destination + i * 2), product));
+    }
+    scalarComplexMultiplyAdd(destination + i * 2, a + i * 2, b + i * 2, numComplex - i);
+}
+
+GENMUSIC_TARGET("sse2") static void sse2Int16ToFloat(float* destination, const std::int16_t* source, float scale, int numSamples) {
+    const auto scales = _mm_set1_ps(scale);
+    int i = 0;
+    // each half widened to 32 bits by interleaving it with itself and shifting the sign back down
+    for (; i + 8 <= numSamples; i += 8) {
+        const auto packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        const auto low = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+        const auto high = _mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16);
+        _mm_storeu_ps(destination + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scales));
+        _mm_storeu_ps(destination + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scales));
+    }
+    scalarInt16ToFloat(destination + i, source + i, scale, numSamples - i);
+}
+
+GENMUSIC_TARGET("sse2") static void sse2FloatToInt16(std::int16_t* destination, const float* source, float scale, int numSamples) {
+    const auto scales = _mm_set1_ps(scale);
+    const auto lowest = _mm_set1_ps(-32767.0f);
+    const auto highest = _mm_set1_ps(32767.0f);
+    int i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const auto low = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(source + i), scales), lowest), highest));
+        const auto high = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(source + i + 4), scales), lowest), highest));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packs_epi32(low, high));
+    }
+    scalarFloatToInt16(destination + i, source + i, scale, numSamples - i);
+}
+
+//==============================================================================
+// AVX2, eight at a time
+
+GENMUSIC_TARGET("avx2") static void avx2ApplyGainRamp(float* samples, float startGain, float endGain, int numSamples) {
+    const auto increment = (endGain - startGain) / static_cast<float>(numSamples);
+    const auto ramp = _mm256_add_ps(_mm256_set1_ps(startGain), _mm256_mul_ps(_mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f), _mm256_set1_ps(increment)));
+    int i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const auto gains = _mm256_add_ps(ramp, _mm256_set1_ps(increment * static_cast<float>(i)));
+        _mm256_storeu_ps(samples + i, _mm256_mul_ps(_mm256_loadu_ps(samples + i), gains));
+    }
+    for (; i < numSamples; ++i) {
+        samples[i] *= startGain + increment * static_cast<float>(i);
+    }
+}
+
+GENMUSIC_TARGET("avx2") static void avx2MultiplyAdd(float* destination, const float* source, const float* envelope, int numSamples) {
+    int i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const auto product = _mm256_mul_ps(_mm256_loadu_ps(source + i), _mm256_loadu_ps(envelope + i));
+        _mm256_storeu_ps(destination + i, _mm256_add_ps(_mm256_loadu_ps(destination + i), product));
+    }
+    scalarMultiplyAdd(destination + i, source + i, envelope + i, numSamples - i);
+}
+
+GENMUSIC_TARGET("avx2") static void avx2AddScaled(float* destination, const float* source, float gain, int numSamples) {
+    const auto gains = _mm256_set1_ps(gain);
+    int i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        _mm256_storeu_ps(destination + i, _mm256_add_ps(_mm256_loadu_ps(destination + i), _mm256_mul_ps(_mm256_loadu_ps(source + i), gains)));
+    }
+    scalarAddScaled(destination + i, source + i, gain, numSamples - i);
+}
+
+GENMUSIC_TARGET("avx2") static void avx2StereoMatrix(float* left, float* right, float leftFromLeft, float leftFromRight, float rightFromLeft, float rightFromRight, int numSamples) {
+    const auto ll = _mm256_set1_ps(leftFromLeft);
+    const auto lr = _mm256_set1_ps(leftFromRight);
+    const auto rl = _mm256_set1_ps(rightFromLeft);
+    const auto rr = _mm256_set1_ps(rightFromRight);
+    int i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const auto l = _mm256_loadu_ps(left + i);
+        const auto r = _mm256_loadu_ps(right + i);
+        _mm256_storeu_ps(left + i, _mm256_add_ps(_mm256_mul_ps(l, ll), _mm256_mul_ps(r, lr)));
+        _mm256_storeu_ps(right + i, _mm256_add_ps(_mm256_mul_ps(l, rl), _mm256_mul_ps(r, rr)));
+    }
+    scalarStereoMatrix(left + i, right + i, leftFromLeft, leftFromRight, rightFromLeft, rightFromRight, numSamples - i);
+}
+
+GENMUSIC_TARGET("avx2") static void avx2ComplexMultiplyAdd(float* destination, const float* a, const float* b, int numComplex) {
+    int i = 0;
+    for (; i + 4 <= numComplex; i += 4) {
+        const auto x = _mm256_loadu_ps(a + i * 2);
+        const auto y = _mm256_loadu_ps(b + i * 2);
+        const auto swapped = _mm256_permute_ps(y, 0xb1);
+        const auto product = _mm256_addsub_ps(_mm256_mul_ps(_mm256_moveldup_ps(x), y), _mm256_mul_ps(_mm256_movehdup_ps(x), swapped));
+        _mm256_storeu_ps(destination + i * 2, _mm256_add_ps(_mm256_loadu_ps(destination + i * 2), product));
+    }
+    scalarComplexMultiplyAdd(destination + i * 2, a + i * 2, b + i * 2, numComplex - i);
+}
+
+GENMUSIC_TARGET("avx2") static void avx2Int16ToFloat(float* destination, const std::int16_t* source, float scale, int numSamples) {
+    const auto scales = _mm256_set1_ps(scale);
+    int i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const auto widened = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)));
+        _mm256_storeu_ps(destination + i, _mm256_mul_ps(_mm256_cvtepi32_ps(widened), scales));
+    }
+    scalarInt16ToFloat(destination + i, source + i, scale, numSamples - i);
+}
+
+GENMUSIC_TARGET("avx2") static void avx2FloatToInt16(std::int16_t* destination, const float* source, float scale, int numSamples) {
+    const auto scales = _mm256_set1_ps(scale);
+    const auto lowest = _mm256_set1_ps(-32767.0f);
+    const auto highest = _mm256_set1_ps(32767.0f);
+    int i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const auto rounded = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(source + i), scales), lowest), highest));
+        const auto packed = _mm_packs_epi32(_mm256_castsi256_si128(rounded), _mm256_extracti128_si256(rounded, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), packed);
+    }
+    scalarFloatToInt16(destination + i, source + i, scale, numSamples - i);
+}
+
+//==============================================================================
+// AVX-512, sixteen at a time
+
+GENMUSIC_TARGET("avx512f") static void avx512ApplyGainRamp(float* samples, float startGain, float endGain, int numSamples) {
+    const auto increment = (endGain - startGain) / static_cast<float>(numSamples);
+    const auto offsets = _mm512_set_ps(15.0f, 14.0f, 13.0f, 12.0f, 11.0f, 10.0f, 9.0f, 8.0f, 7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+    const auto ramp = _mm512_add_ps(_mm512_set1_ps(startGain), _mm512_mul_ps(offsets, _mm512_set1_ps(increment)));
+    int i = 0;
+    for (; i + 16 <= numSamples; i += 16) {
+        const auto gains = _mm512_add_ps(ramp, _mm512_set1_ps(increment * static_cast<float>(i)));
+        _mm512_storeu_ps(samples + i, _mm512_mul_ps(_mm512_loadu_ps(samples + i), gains));
+    }
+    for (; i < numSamples; ++i) {
+        samples[i] *= startGain + increment * static_cast<float>(i);
+    }
+}
+
+GENMUSIC_TARGET("avx512f") static void avx512MultiplyAdd(float* destination, const float* source, const float* envelope, int numSamples) {
+    int i = 0;
+    for (; i + 16 <= numSamples; i += 16) {
+        const auto product = _mm512_mul_ps(_mm512_loadu_ps(source + i), _mm512_loadu_ps(envelope + i));
+        _mm512_storeu_ps(destination + i, _mm512_add_ps(_mm512_loadu_ps(destination + i), product));
+    }
+    scalarMultiplyAdd(destination + i, source + i, envelope + i, numSamples - i);
+}
+
+GENMUSIC_TARGET("avx512f") static void avx512AddScaled(float* destination, const float* source, float gain, int numSamples) {
+    const auto gains = _mm512_set1_ps(gain);
+    int i = 0;
+    for (; i + 16 <= numSamples; i += 16) {
+        _mm512_storeu_ps(destination + i, _mm512_add_ps(_mm512_loadu_ps(destination + i), _mm512_mul_ps(_mm512_loadu_ps(source + i), gains)));
+    }
+    scalarAddScaled(destination + i, source + i, gain, numSamples - i);
+}
+
+GENMUSIC_TARGET("avx512f") static void avx512StereoMatrix(float* left, float* right, float leftFromLeft, float leftFromRight, float rightFromLeft, float rightFromRight, int numSamples) {
+    const auto ll = _mm512_set1_ps(leftFromLeft);
+    const auto lr = _mm512_set1_ps(leftFromRight);
+    const auto rl = _mm512_set1_ps(rightFromLeft);
+    const auto rr = _mm512_set1_ps(rightFromRight);
+    int i = 0;
+    for (; i + 16 <= numSamples; i += 16) {
+        const auto l = _mm512_loadu_ps(left + i);
+        const auto r = _mm512_loadu_ps(right + i);
+        _mm512_storeu_ps(left + i, _mm512_add_ps(_mm512_mul_ps(l, ll), _mm512_mul_ps(r, lr)));
+        _mm512_storeu_ps(right + i, _mm512_add_ps(_mm512_mul_ps(l, rl), _mm512_mul_ps(r, rr)));
+    }
+    scalarStereoMatrix(left + i, right + i, leftFromLeft, leftFromRight, rightFromLeft, rightFromRight, numSamples - i);
+}
+
+GENMUSIC_TARGET("avx512f") static void avx512ComplexMultiplyAdd(float* destination, const float* a, const float* b, int numComplex) {
+    int i = 0;
+    for (; i + 8 <= numComplex; i += 8) {
+        const auto x = _mm512_loadu_ps(a + i * 2);
+        const auto y = _mm512_loadu_ps(b + i * 2);
+        const auto swapped = _mm512_permute_ps(y, 0xb1);
+        const auto product = _mm512_fmaddsub_ps(_mm512_moveldup_ps(x), y, _mm512_mul_ps(_mm512_movehdup_ps(x), swapped));
+        _mm512_storeu_ps(destination + i * 2, _mm512_add_ps(_mm512_loadu_ps(destination + i * 2), product));
+    }
+    scalarComplexMultiplyAdd(destination + i * 2, a + i * 2, b + i * 2, numComplex - i);
+}
+
+GENMUSIC_TARGET("avx512f") static void avx512Int16ToFloat(float* destination, const std::int16_t* source, float scale, int numSamples) {
+    const auto scales = _mm512_set1_ps(scale);
+    int i = 0;
+    for (; i + 16 <= numSamples; i += 16) {
+        const auto widened = _mm512_cvtepi16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i)));
+        _mm512_storeu_ps(destination + i, _mm512_mul_ps(_mm512_cvtepi32_ps(widened), scales));
+    }
+    scalarInt16ToFloat(destination + i, source + i, scale, numSamples - i);
+}
+
+GENMUSIC_TARGET("avx512f") static void avx512FloatToInt16(std::int16_t* destination, const float* source, float scale, int numSamples) {
+    const auto scales = _mm512_set1_ps(scale);
+    const auto lowest = _mm512_set1_ps(-32767.0f);
+    const auto highest = _mm512_set1_ps(32767.0f);
+    int i = 0;
+    for (; i + 16 <= numSamples; i += 16) {
+        const auto rounded = _mm512_cvtps_epi32(_mm512_min_ps(_mm512_max_ps(_mm512_mul_ps(_mm512_loadu_ps(source + i), scales), lowest), highest));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm512_cvtsepi32_epi16(rounded));
+    }
+    scalarFloatToInt16(destination + i, source + i, scale, numSamples - i);
+}
+#endif
+
+#if GENMUSIC_KERNELS_NEON
+//==============================================================================
+// NEON, four at a time. Every 64 bit ARM core has it so there's nothing to choose between
+
+static void neonApplyGainRamp(float* samples, float startGain, float endGain, int numSamples) {
+    const auto increment = (endGain - startGain) / static_cast<float>(numSamples);
+    const float offsets[] = {0.0f, 1.0f, 2.0f, 3.0f};
+    const auto ramp = vmlaq_n_f32(vdupq_n_f32(startGain), vld1q_f32(offsets), increment);
+    int i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        const auto gains = vaddq_f32(ramp, vdupq_n_f32(increment * static_cast<float>(i)));
+        vst1q_f32(samples + i, vmulq_f32(vld1q_f32(samples + i), gains));
+    }
+    for (; i < numSamples; ++i) {
+        samples[i] *= startGain + increment * static_cast<float>(i);
+    }
+}
+
+static void neonMultiplyAdd(float* destination, const float* source, const float* envelope, int numSamples) {
+    int i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        const auto product = vmulq_f32(vld1q_f32(source + i), vld1q_f32(envelope + i));
+        vst1q_f32(destination + i, vaddq_f32(vld1q_f32(destination + i), product));
+    }
+    scalarMultiplyAdd(destination + i, source + i, envelope + i, numSamples - i);
+}
+
+static void neonAddScaled(float* destination, const float* source, float gain, int numSamples) {
+    int i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        vst1q_f32(destination + i, vaddq_f32(vld1q_f32(destination + i), vmulq_n_f32(vld1q_f32(source + i), gain)));
+    }
+    scalarAddScaled(destination + i, source + i, gain, numSamples - i);
+}
+
+static void neonStereoMatrix(float* left, float* right, float leftFromLeft, float leftFromRight, float rightFromLeft, float rightFromRight, int numSamples) {
+    int i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        const auto l = vld1q_f32(left + i);
+        const auto r = vld1q_f32(right + i);
+        vst1q_f32(left + i, vmlaq_n_f32(vmulq_n_f32(l, leftFromLeft), r, leftFromRight));
+        vst1q_f32(right + i, vmlaq_n_f32(vmulq_n_f32(l, rightFromLeft), r, rightFromRight));
+    }
+    scalarStereoMatrix(left + i, right + i, leftFromLeft, leftFromRight, rightFromLeft, rightFromRight, numSamples - i);
+}
+
+static void neonComplexMultiplyAdd(float* destination, const float* a, const float* b, int numComplex) {
+    int i = 0;
+    for (; i + 4 <= numComplex; i += 4) {
+        const auto x = vld2q_f32(a + i * 2);
+        const auto y = vld2q_f32(b + i * 2);
+        auto sum = vld2q_f32(destination + i * 2);
+        sum.val[0] = vmlsq_f32(vmlaq_f32(sum.val[0], x.val[0], y.val[0]), x.val[1], y.val[1]);
+        sum.val[1] = vmlaq_f32(vmlaq_f32(sum.val[1], x.val[0], y.val[1]), x.val[1], y.val[0]);
+        vst2q_f32(destination + i * 2, sum);
+    }
+    scalarComplexMultiplyAdd(destination + i * 2, a + i * 2, b + i * 2, numComplex - i);
+}
+
+static void neonInt16ToFloat(float* destination, const std::int16_t* source, float scale, int numSamples) {
+    int i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const auto packed = vld1q_s16(source + i);
+        vst1q_f32(destination + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(packed))), scale));
+        vst1q_f32(destination + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(packed))), scale));
+    }
+    scalarInt16ToFloat(destination + i, source + i, scale, numSamples - i);
+}
+
+static void neonFloatToInt16(std::int16_t* destination, const float* source, float scale, int numSamples) {
+    const auto lowest = vdupq_n_f32(-32767.0f);
+    const auto highest = vdupq_n_f32(32767.0f);
+    int i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const auto low = vcvtnq_s32_f32(vminq_f32(vmaxq_f32(vmulq_n_f32(vld1q_f32(source + i), scale), lowest), highest));
+        const auto high = vcvtnq_s32_f32(vminq_f32(vmaxq_f32(vmulq_n_f32(vld1q_f32(source + i + 4), scale), lowest), highest));
+        vst1q_s16(destination + i, vcombine_s16(vqmovn_s32(low), vqmovn_s32(high)));
+    }
+    scalarFloatToInt16(destination + i, source + i, scale, numSamples - i);
+}
+#endif
+
+//==============================================================================
+
+static DSPKernels selectKernels() {
+    const DSPKernels scalar = {"scalar", scalarApplyGainRamp, scalarMultiplyAdd, scalarAddScaled, scalarStereoMatrix, scalarComplexMultiplyAdd, scalarInt16ToFloat, scalarFloatToInt16};
+
+    // the widest set allowed, everything is allowed unless the environment says otherwise
+    const juce::StringArray levels = {"scalar", "sse2", "avx2", "avx512"};
+    const auto requested = juce::SystemStats::getEnvironmentVariable("GENMUSIC_SIMD", "avx512").toLowerCase();
+    const auto cap = levels.contains(requested) ? levels.indexOf(requested) : levels.size() - 1;
+    juce::ignoreUnused(cap);
+
+#if GENMUSIC_KERNELS_X86
+    if (cap >= 3 && juce::SystemStats::hasAVX512F()) {
+        return {"avx512", avx512ApplyGainRamp, avx512MultiplyAdd, avx512AddScaled, avx512StereoMatrix, avx512ComplexMultiplyAdd, avx512Int16ToFloat, avx512FloatToInt16};
+    }
+    if (cap >= 2 && juce::SystemStats::hasAVX2()) {
+        return {"avx2", avx2ApplyGainRamp, avx2MultiplyAdd, avx2AddScaled, avx2StereoMatrix, avx2ComplexMultiplyAdd, avx2Int16ToFloat, avx2FloatToInt16};
+    }
+    if (cap >= 1 && juce::SystemStats::hasSSE2()) {
+        return {"sse2", sse2ApplyGainRamp, sse2MultiplyAdd, sse2AddScaled, sse2StereoMatrix, sse2ComplexMultiplyAdd, sse2Int16ToFloat, sse2FloatToInt16};
+    }
+#elif GENMUSIC_KERNELS_NEON
+    if (cap >= 1) {
+        return {"neon", neonApplyGainRamp, neonMultiplyAdd, neonAddScaled, neonStereoMatrix, neonComplexMultiplyAdd, neonInt16ToFloat, neonFloatToInt16};
+    }
+#endif
+    return scalar;
+}
+
+const DSPKernels& DSPKernels::get() {
+    static const DSPKernels kernels = selectKernels();
+    return kernels;
+}
@@ -0,0 +1,44 @@
+/*
+  ==============================================================================
+
+    DSPKernels.h
+    Created: 19 Oct 2026 10:26:31am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cstdint>
+
+/*
+    The inner loops the voices, effects and mixers share, each written once per instruction set. get() picks the
+    widest set the CPU supports the first time it's called: AVX-512, AVX2, SSE2 or plain C++ on x86, NEON on ARM.
+    GENMUSIC_SIMD=scalar, sse2, avx2 or avx512 in the environment caps the choice, for comparing them.
+
+    Nothing here allocates, so every kernel is safe on the audio thread. Pointers don't need to be aligned but they
+    mustn't overlap.
+ */
+struct DSPKernels {
+    // the instruction set in use, for logs and reports
+    const char* name;
+
+    // samples[i] *= a gain moving linearly from startGain, reaching endGain just after the last sample
+    void (*applyGainRamp)(float* samples, float startGain, float endGain, int numSamples);
+    // destination[i] += source[i] * envelope[i]
+    void (*multiplyAdd)(float* destination, const float* source, const float* envelope, int numSamples);
+    // destination[i] += source[i] * gain
+    void (*addScaled)(float* destination, const float* source, float gain, int numSamples);
+    // in place, left = left * leftFromLeft + right * leftFromRight and right the same with its own pair. Every
+    // stateless stereo stage (gain, pan, polarity, mid/side width) is one of these, see StereoMatrixChain
+    void (*stereoMatrix)(float* left, float* right, float leftFromLeft, float leftFromRight, float rightFromLeft, float rightFromRight, int numSamples);
+    // destination += a * b over interleaved real and imaginary pairs, the spectra juce::dsp::FFT's real only transforms
+    // produce
+    void (*complexMultiplyAdd)(float* destination, const float* a, const float* b, int numComplex);
+    // destination[i] = source[i] * scale
+    void (*int16ToFloat)(float* destination, const std::int16_t* source, float scale, int numSamples);
+    // destination[i] = source[i] * scale, clamped to +-32767 and rounded to the nearest integer
+    void (*floatToInt16)(std::int16_t* destination, const float* source, float scale, int numSamples);
+
+    static const DSPKernels& get();
+};
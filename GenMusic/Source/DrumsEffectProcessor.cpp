@@ -9,6 +9,22 @@
 */
 
 #include "DrumsEffectProcessor.h"
+#include "Utilities.h"
 
+// holds the kick's low end steady and takes the edge off the stick without squashing either
+DrumsEffectProcessor::DrumsEffectProcessor(const RenderSettings& settings) : compressor(settings.sampleRate, {150.0f, 3000.0f}, {
+    {-18.0f, 3.0f, 10.0f, 120.0f, 2.0f},
+    {-20.0f, 2.5f, 5.0f, 80.0f, 1.0f},
+    {-22.0f, 2.0f, 2.0f, 60.0f, 1.0f},
+}) {
+    configurationHash = typeid(DrumsEffectProcessor).hash_code();
+    hashCombine(configurationHash, compressor.getConfigurationHash());
+}
 
-void DrumsEffectProcessor::process(juce::AudioBuffer<float>& buffer) {}
+void DrumsEffectProcessor::process(juce::AudioBuffer<float>& buffer) {
+    compressor.process(buffer);
+}
+
+void DrumsEffectProcessor::reset() {
+    compressor.reset();
+}
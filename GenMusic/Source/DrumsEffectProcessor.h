@@ -10,10 +10,18 @@
 
 #pragma once
 #include "EffectProcessor.h"
+#include "MultibandCompressor.h"
+#include "RenderSettings.h"
 
 
 class DrumsEffectProcessor : public EffectProcessor {
 public:
+    DrumsEffectProcessor(const RenderSettings& settings);
     
     void process(juce::AudioBuffer<float>& buffer) override;
+    void reset() override;
+    std::size_t getConfigurationHash() const override { return configurationHash; }
+private:
+    MultibandCompressor compressor;
+    std::size_t configurationHash = 0;
 };
@@ -15,4 +15,10 @@ class EffectProcessor {
 public:
     virtual ~EffectProcessor() = default;
     virtual void process(juce::AudioBuffer<float>& buffer) = 0;
+    // clears any tails or internal state left over from the last buffer
+    virtual void reset() {}
+    // true while it's processing an audio callback's blocks, where it mustn't wait on anything that takes long
+    virtual void setRealtime(bool) {}
+    // changes whenever the processor would treat the same input differently, used to key cached stems
+    virtual std::size_t getConfigurationHash() const = 0;
 };
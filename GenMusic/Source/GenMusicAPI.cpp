@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    GenMusicAPI.cpp
+    Created: 19 Oct 2026 10:16:02am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "GenMusicAPI.h"
+#include <JuceHeader.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "RenderEngine.h"
+#include "RenderSettings.h"
+#include "SampleBank.h"
+#include "Utilities.h"
+
+struct GenMusicEngine {
+    std::unique_ptr<RenderEngine> engine;
+    double sampleRate;
+    // a render that didn't fit the caller's buffer, kept until they come back with a bigger one
+    std::string heldSeed;
+    juce::AudioBuffer<float> heldRender;
+    bool isHoldingRender = false;
+};
+
+static thread_local std::string lastError;
+
+static void interleave(const juce::AudioBuffer<float>& render, float* interleaved) {
+    const auto* left = render.getReadPointer(0);
+    const auto* right = render.getReadPointer(render.getNumChannels() > 1 ? 1 : 0);
+    for (int frame = 0; frame < render.getNumSamples(); ++frame) {
+        interleaved[frame * GENMUSIC_NUM_CHANNELS] = left[frame];
+        interleaved[frame * GENMUSIC_NUM_CHANNELS + 1] = right[frame];
+    }
+}
+
+// nothing may throw across the C boundary, every failure ends up in lastError instead
+template <typename Function>
+static GenMusicStatus guarded(Function&& function) {
+    try {
+        return function();
+    } catch (const std::invalid_argument& e) {
+        lastError = e.what();
+        return GENMUSIC_INVALID_ARGUMENT;
+    } catch (const std::exception& e) {
+        lastError = e.what();
+        return GENMUSIC_FAILED;
+    } catch (...) {
+        lastError = "unknown error";
+        return GENMUSIC_FAILED;
+    }
+}
+
+int genmusic_api_version(void) {
+    return GENMUSIC_API_VERSION;
+}
+
+const char* genmusic_last_error(void) {
+    return lastError.c_str();
+}
+
+GenMusicStatus genmusic_engine_create(const GenMusicEngineConfig* config, GenMusicEngine** engine) {
+    return guarded([&]() {
+        if (config == nullptr || engine == nullptr) {
+            throw std::invalid_argument("config and engine can't be NULL");
+        }
+        *engine = nullptr;
+
+        // process wide, so the first engine decides and a later one can't change it under another's render
+        static std::once_flag verboseLoggingSet;
+        std::call_once(verboseLoggingSet, [&]() {
+            verboseLogging = config->verbose != 0;
+        });
+
+        std::shared_ptr<SampleBank> bank;
+        if (config->sampleBankPath != nullptr) {
+            bank = std::make_shared<SampleBank>(juce::File::getCurrentWorkingDirectory().getChildFile(config->sampleBankPath));
+        }
+
+        auto settings = config->preview != 0 ? RenderSettings::forPreview() : RenderSettings::forFinal();
+        if (config->sampleRate > 0.0) {
+            settings.sampleRate = config->sampleRate;
+        } else if (bank) {
+            // a bank only works at the rate it was baked at, so that's the default when there is one
+            settings.sampleRate = bank->getSampleRate();
+        }
+
+        auto created = std::make_unique<GenMusicEngine>();
+        created->engine = std::make_unique<RenderEngine>(settings, bank);
+        created->sampleRate = settings.sampleRate;
+        *engine = created.release();
+        return GENMUSIC_OK;
+    });
+}
+
+void genmusic_engine_destroy(GenMusicEngine* engine) {
+    delete engine;
+}
+
+double genmusic_engine_get_sample_rate(const GenMusicEngine* engine) {
+    return engine != nullptr ? engine->sampleRate : 0.0;
+}
+
+GenMusicStatus genmusic_engine_render(GenMusicEngine* engine, const char* seed, float* interleaved, int64_t capacityInFrames, int64_t* numFrames) {
+    return guarded([&]() {
+        if (engine == nullptr || seed == nullptr || numFrames == nullptr || capacityInFrames < 0 || (interleaved == nullptr && capacityInFrames > 0)) {
+            throw std::invalid_argument("engine, seed and numFrames can't be NULL, interleaved can only be NULL with no capacity");
+        }
+
+        if (engine->isHoldingRender && engine->heldSeed == seed) {
+            *numFrames = engine->heldRender.getNumSamples();
+            if (capacityInFrames < engine->heldRender.getNumSamples()) {
+                return GENMUSIC_BUFFER_TOO_SMALL;
+            }
+            interleave(engine->heldRender, interleaved);
+            engine->isHoldingRender = false;
+            return GENMUSIC_OK;
+        }
+
+        engine->isHoldingRender = false;
+        bool fitted = false;
+        engine->engine->render(seed, [&](const juce::AudioBuffer<float>& mix) {
+            *numFrames = mix.getNumSamples();
+            if (capacityInFrames >= mix.getNumSamples()) {
+                // the one pass over the audio, straight from the mix into the caller's memory
+                interleave(mix, interleaved);
+                fitted = true;
+            } else {
+                // only a render that doesn't fit is copied, it has to outlive the graph until the caller comes back
+                engine->heldRender.makeCopyOf(mix, true);
+            }
+        });
+
+        if (!fitted) {
+            engine->heldSeed = seed;
+            engine->isHoldingRender = true;
+            return GENMUSIC_BUFFER_TOO_SMALL;
+        }
+        return GENMUSIC_OK;
+    });
+}
@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    GenMusicAPI.h
+    Created: 19 Oct 2026 10:16:02am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+/*
+    The C interface of the GenMusicEngine library, for rendering songs in-process instead of running the GenMusic
+    app once per song. Plain C so it can be loaded from any language, nothing in it changes without bumping
+    GENMUSIC_API_VERSION.
+
+    Create an engine once, it decodes and repitches the samples (or maps a baked bank) so that's the slow part, then
+    render as many seeds as needed. Audio comes back as interleaved 32 bit float stereo written straight from the mix
+    into memory the caller owns:
+
+        GenMusicEngine* engine = NULL;
+        GenMusicEngineConfig config = { 48000.0, 0, "samples.gmsb", 0 };
+        if (genmusic_engine_create(&config, &engine) != GENMUSIC_OK) { puts(genmusic_last_error()); }
+
+        int64_t frames = 0;
+        genmusic_engine_render(engine, "seed", NULL, 0, &frames);    // GENMUSIC_BUFFER_TOO_SMALL, frames is the length
+        float* audio = malloc(frames * GENMUSIC_NUM_CHANNELS * sizeof(float));
+        genmusic_engine_render(engine, "seed", audio, frames, &frames);  // copies out the render the first call kept
+
+    Asking for the length costs a copy of the render to hold on to, a caller that already has a buffer big enough
+    (the last song's, say) gets the mix interleaved into it with no copy in between.
+
+        genmusic_engine_destroy(engine);
+
+    An engine isn't thread safe, give each thread its own.
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+ #define GENMUSIC_EXPORT __declspec(dllexport)
+#else
+ #define GENMUSIC_EXPORT __attribute__((visibility("default")))
+#endif
+
+#define GENMUSIC_API_VERSION 1
+#define GENMUSIC_NUM_CHANNELS 2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct GenMusicEngine GenMusicEngine;
+
+typedef enum {
+    GENMUSIC_OK = 0,
+    GENMUSIC_INVALID_ARGUMENT = 1,
+    // numFrames has been set to how many frames the song needs, the render is kept for the next call
+    GENMUSIC_BUFFER_TOO_SMALL = 2,
+    GENMUSIC_FAILED = 3
+} GenMusicStatus;
+
+typedef struct {
+    // 0 for the default: the bank's rate, otherwise 48k or 22.05k for a preview
+    double sampleRate;
+    // non zero for the faster repitching and lighter effects the audition UI uses
+    int preview;
+    // a bank baked with `GenMusic bake`, NULL to load and repitch the samples at startup
+    const char* sampleBankPath;
+    // non zero to let the engine log its progress to stdout. Logging is shared by the whole process, only the first
+    // engine created sets it
+    int verbose;
+} GenMusicEngineConfig;
+
+// the version the library was built with, compare it to GENMUSIC_API_VERSION
+GENMUSIC_EXPORT int genmusic_api_version(void);
+
+// why the last call on this thread failed, valid until the next call on this thread
+GENMUSIC_EXPORT const char* genmusic_last_error(void);
+
+GENMUSIC_EXPORT GenMusicStatus genmusic_engine_create(const GenMusicEngineConfig* config, GenMusicEngine** engine);
+GENMUSIC_EXPORT void genmusic_engine_destroy(GenMusicEngine* engine);
+
+GENMUSIC_EXPORT double genmusic_engine_get_sample_rate(const GenMusicEngine* engine);
+
+// Renders the song for seed into interleaved, which has room for capacityInFrames frames of GENMUSIC_NUM_CHANNELS
+// samples, and sets numFrames to the frames written. When it doesn't fit (interleaved can be NULL to ask) nothing is
+// written, numFrames is set to the frames needed and the render is held until the next call, so asking again with
+// the same seed and a big enough buffer doesn't render twice.
+GENMUSIC_EXPORT GenMusicStatus genmusic_engine_render(GenMusicEngine* engine, const char* seed, float* interleaved, int64_t capacityInFrames, int64_t* numFrames);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+
+    GrooveMachine.cpp
+    Created: 19 Oct 2026 9:59:15am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "GrooveMachine.h"
+#include <algorithm>
+#include <stdexcept>
+#include "Utilities.h"
+
+GrooveMachine::GrooveMachine(std::vector<unsigned char> seed, double grooveLength, std::vector<GrooveLane> lanes) : seed(seed), grooveLength(grooveLength), lanes(lanes), lanePositions(lanes.size(), 0.0) {
+    size_t subdivisionCount = 0;
+    for (const auto& lane : this->lanes) {
+        // verify that the playWeighting are all chances 0-1
+        for (auto weight : lane.playWeighting) {
+            if (weight < 0 || weight > 1) {
+                throw std::invalid_argument("All playWeighting must be between 0 and 1");
+            }
+        }
+        if (lane.subdivisions.empty() || lane.subdivisions.size() != lane.subdivisionWeighting.size()) {
+            throw std::invalid_argument("Every subdivision needs a weight");
+        }
+        
+        // verify that weighting length is equal to grooveLength / the smallest subdivision
+        const auto smallestSubdivision = *std::min_element(lane.subdivisions.begin(), lane.subdivisions.end());
+        if (lane.playWeighting.size() != (grooveLength / smallestSubdivision)) {
+            throw std::invalid_argument("Weighting length must be equal to grooveLength / the smallest subdivision");
+        }
+        // verify that the lane's part of the seed is there
+        if (lane.seedOffset < 0 || seed.size() < static_cast<size_t>(lane.seedOffset) + lane.playWeighting.size()) {
+            throw std::invalid_argument("Seed is too short for every lane's seedOffset + weighting length");
+        }
+        
+        subdivisionOffsets.push_back(subdivisionCount);
+        subdivisionCount += lane.subdivisions.size();
+    }
+    
+    streamContext = makeContext();
+}
+
+GrooveContext GrooveMachine::makeContext() const {
+    GrooveContext ctx;
+    ctx.playCompensation.assign(lanes.size(), 0.0);
+    ctx.subdivisionCompensation.assign(subdivisionOffsets.empty() ? 0 : subdivisionOffsets.back() + lanes.back().subdivisions.size(), 0.0);
+    return ctx;
+}
+
+std::vector<Note> GrooveMachine::generate() {
+    std::vector<Note> notes;
+    auto ctx = makeContext();
+    
+    for (int loop = 0; loop < LOOPS; ++loop) {
+        generateLoop(ctx, loop * PHRASE_LENGTH_IN_BEATS, notes);
+    }
+    
+    return notes;
+}
+
+std::vector<Note> GrooveMachine::generatePhrase(int phraseIndex, double phraseStartBeat) {
+    std::vector<Note> notes;
+    generateLoop(streamContext, phraseStartBeat, notes);
+    return notes;
+}
+
+void GrooveMachine::resetStreamContext() {
+    streamContext = makeContext();
+}
+
+void GrooveMachine::generateLoop(GrooveContext& ctx, double loopStartBeat, std::vector<Note>& notes) {
+    for (int bar = 0; bar < BAR_COUNT * 4; bar += grooveLength) {
+        std::fill(lanePositions.begin(), lanePositions.end(), 0.0);
+        
+        while (true) {
+            // the lane with the earliest next hit goes first
+            size_t nextLane = lanes.size();
+            for (size_t lane = 0; lane < lanes.size(); ++lane) {
+                if (lanePositions[lane] < grooveLength && (nextLane == lanes.size() || lanePositions[lane] < lanePositions[nextLane])) {
+                    nextLane = lane;
+                }
+            }
+            if (nextLane == lanes.size()) {
+                break;
+            }
+            advanceLane(ctx, nextLane, loopStartBeat + bar, notes);
+        }
+    }
+}
+
+void GrooveMachine::advanceLane(GrooveContext& ctx, size_t laneIndex, double location, std::vector<Note>& notes) {
+    const auto& lane = lanes[laneIndex];
+    auto& groovePos = lanePositions[laneIndex];
+    auto& playCompensation = ctx.playCompensation[laneIndex];
+    double* subdivisionCompensation = ctx.subdivisionCompensation.data() + subdivisionOffsets[laneIndex];
+    
+    int idx = static_cast<int>((groovePos / grooveLength) * lane.playWeighting.size());
+    double playChance = lane.playWeighting.at(idx);
+    unsigned char seedVal = seed.at(lane.seedOffset + idx);
+    if (playCompensation > 0.0) {
+        playChance /= playCompensation; // this is a very simple implementation, we probably want to flesh out what it means to compensate for a note
+    }
+    
+    std::vector<std::pair<double, int>> subdivisionToWeight;
+    for (size_t j = 0; j < lane.subdivisions.size(); j++) {
+        int subdivisionWeight = lane.subdivisionWeighting[j];
+        if (subdivisionCompensation[j] > 0.0) {
+            subdivisionWeight /= subdivisionCompensation[j];
+        }
+        subdivisionToWeight.push_back(std::make_pair(lane.subdivisions[j], subdivisionWeight));
+    }
+    
+    double subToUse = selectWeightedRandom(subdivisionToWeight, static_cast<int>(seedVal));
+    size_t indexOfSubToUse = 0;
+    for (size_t j = 0; j < lane.subdivisions.size(); j++) {
+        if (lane.subdivisions[j] == subToUse) {
+            indexOfSubToUse = j;
+            break;
+        }
+    }
+    
+    double compChange = std::max(subToUse, 1.0);
+    if (basicChance(seedVal, playChance)) {
+        notes.push_back(Note(lane.midiNoteNumber, location + groovePos, subToUse));
+        playCompensation += compChange;
+        subdivisionCompensation[indexOfSubToUse] += compChange;
+    } else {
+        playCompensation -= compChange;
+        subdivisionCompensation[indexOfSubToUse] -= compChange;
+    }
+    
+    groovePos += subToUse;
+}
@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    GrooveMachine.h
+    Created: 19 Oct 2026 9:59:15am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <vector>
+#include "Note.h"
+#include "NoteGenerator.h"
+
+// one drum sound in the machine
+struct GrooveLane {
+    int midiNoteNumber;
+    // the chance of each potential subdivision being played
+    std::vector<double> playWeighting;
+    std::vector<double> subdivisions;
+    std::vector<int> subdivisionWeighting;
+    // where this lane's values start in the machine's seed
+    int seedOffset;
+};
+
+// Owned by the machine for all of its lanes. Everything is kept flat: the compensation for lane l's subdivision j
+// lives at subdivisionOffsets[l] + j.
+struct GrooveContext {
+    std::vector<double> playCompensation;
+    std::vector<double> subdivisionCompensation;
+};
+
+/*
+    Generates every drum lane in one pass over the groove. Each groove-length cycle walks the lanes in time order,
+    always advancing whichever lane's next hit comes first, so the notes come out sorted by start time (lanes in the
+    order they were given when they land together).
+ */
+class GrooveMachine : public NoteGenerator {
+public:
+    GrooveMachine(std::vector<unsigned char> seed, double grooveLength, std::vector<GrooveLane> lanes);
+    std::vector<Note> generate() override;
+    
+protected:
+    // one pass over the groove, the compensation keeps building up from phrase to phrase
+    std::vector<Note> generatePhrase(int phraseIndex, double phraseStartBeat) override;
+    void resetStreamContext() override;
+    
+private:
+    std::vector<unsigned char> seed;
+    double grooveLength;
+    std::vector<GrooveLane> lanes;
+    std::vector<size_t> subdivisionOffsets;
+    
+    GrooveContext streamContext;
+    // where each lane is within the current groove cycle, only kept as a member so a pass doesn't allocate
+    std::vector<double> lanePositions;
+    
+    GrooveContext makeContext() const;
+    void generateLoop(GrooveContext& ctx, double loopStartBeat, std::vector<Note>& notes);
+    void advanceLane(GrooveContext& ctx, size_t lane, double location, std::vector<Note>& notes);
+};
@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    ImpulseResponse.cpp
+    Created: 19 Oct 2026 10:41:43am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "ImpulseResponse.h"
+#include <functional>
+#include <map>
+#include "SampleLoader.h"
+#include "SyntheticSamples.h"
+#include "Utilities.h"
+
+// the tail below this, relative to the peak, is cut off
+const float TAIL_THRESHOLD_DB = -90.0f;
+
+// responses by identity and rate, held weakly so one nobody uses any more is freed
+static std::shared_ptr<const ImpulseResponse> getShared(std::size_t key, const std::function<std::shared_ptr<const ImpulseResponse>()>& create) {
+    static juce::CriticalSection lock;
+    static std::map<std::size_t, std::weak_ptr<const ImpulseResponse>> responses;
+
+    // held while creating, so engines starting up together transform a response once rather than once each
+    const juce::ScopedLock scopedLock(lock);
+    if (auto existing = responses[key].lock()) {
+        return existing;
+    }
+    auto created = create();
+    responses[key] = created;
+    return created;
+}
+
+std::shared_ptr<const ImpulseResponse> ImpulseResponse::load(const std::string& filePath, double sampleRate) {
+    auto identity = SampleLoader::getFileIdentity(filePath);
+    hashCombine(identity, sampleRate);
+    return getShared(identity, [&]() {
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(juce::File(filePath)));
+        if (reader.get() == nullptr) {
+            throw std::runtime_error("Could not read impulse response " + filePath);
+        }
+        if (reader->numChannels > 2) {
+            throw std::runtime_error("Impulse response " + filePath + " has more than two channels");
+        }
+
+        // not conditioned like a sample, any silence before the first reflection is the room's pre-delay
+        juce::AudioBuffer<float> audio(static_cast<int>(reader->numChannels), static_cast<int>(reader->lengthInSamples));
+        reader->read(&audio, 0, static_cast<int>(reader->lengthInSamples), 0, true, true);
+        if (reader->sampleRate != sampleRate) {
+            logVerbose("Resampling impulse response {} from {} to {}", filePath, reader->sampleRate, sampleRate);
+            audio = SampleLoader::resample(audio, reader->sampleRate, sampleRate);
+        }
+        return std::make_shared<const ImpulseResponse>(std::move(audio), identity);
+    });
+}
+
+std::shared_ptr<const ImpulseResponse> ImpulseResponse::synthetic(double sampleRate) {
+    std::size_t identity = 0;
+    hashCombine(identity, SyntheticSamples::VERSION);
+    hashCombine(identity, std::string("impulse response"));
+    hashCombine(identity, sampleRate);
+    return getShared(identity, [&]() {
+        return std::make_shared<const ImpulseResponse>(SyntheticSamples::impulseResponse(sampleRate), identity);
+    });
+}
+
+ImpulseResponse::ImpulseResponse(juce::AudioBuffer<float> audio, std::size_t identity) : numChannels(audio.getNumChannels()), identity(identity) {
+    if (numChannels < 1 || numChannels > 2) {
+        throw std::invalid_argument("An impulse response has to have one or two channels");
+    }
+
+    const auto peak = audio.getMagnitude(0, audio.getNumSamples());
+    const auto threshold = peak * juce::Decibels::decibelsToGain(TAIL_THRESHOLD_DB, -1000.0f);
+    lengthInSamples = 0;
+    for (int channel = 0; channel < numChannels; ++channel) {
+        const auto* samples = audio.getReadPointer(channel);
+        for (int i = audio.getNumSamples() - 1; i >= lengthInSamples; --i) {
+            if (std::abs(samples[i]) > threshold) {
+                lengthInSamples = i + 1;
+                break;
+            }
+        }
+    }
+    if (lengthInSamples == 0) {
+        throw std::invalid_argument("The impulse response is silent");
+    }
+
+    double energy = 0.0;
+    for (int channel = 0; channel < numChannels; ++channel) {
+        const auto* samples = audio.getReadPointer(channel);
+        for (int i = 0; i < lengthInSamples; ++i) {
+            energy += static_cast<double>(samples[i]) * samples[i];
+        }
+    }
+    const auto gain = static_cast<float>(1.0 / std::sqrt(energy / numChannels));
+
+    directTaps.setSize(numChannels, std::min(DIRECT_TAPS, lengthInSamples));
+    for (int channel = 0; channel < numChannels; ++channel) {
+        directTaps.copyFrom(channel, 0, audio, channel, 0, directTaps.getNumSamples(), gain);
+    }
+
+    int offset = DIRECT_TAPS;
+    for (int size = DIRECT_TAPS; offset < lengthInSamples; size = std::min(size * 4, MAX_PARTITION_SIZE)) {
+        jassert(offset == (size < MAX_PARTITION_SIZE ? size : size * 2));
+        // each size covers up to where the next one starts a whole partition in (two for the longest), the longest
+        // takes whatever's left
+        const auto nextSize = std::min(size * 4, MAX_PARTITION_SIZE);
+        const auto nextStart = nextSize < MAX_PARTITION_SIZE ? nextSize : nextSize * 2;
+        const auto end = std::min(lengthInSamples, size < MAX_PARTITION_SIZE ? nextStart : lengthInSamples);
+
+        Segment segment;
+        segment.partitionSize = size;
+        segment.firstPartition = offset / size;
+        segment.numPartitions = (end - offset + size - 1) / size;
+
+        const auto numBins = size + 1;
+        juce::dsp::FFT fft(juce::findHighestSetBit(static_cast<juce::uint32>(size * 2)));
+        std::vector<float> transform(static_cast<size_t>(size) * 4);
+        for (int channel = 0; channel < numChannels; ++channel) {
+            auto& spectra = segment.spectra.emplace_back(static_cast<size_t>(segment.numPartitions * numBins * 2));
+            for (int partition = 0; partition < segment.numPartitions; ++partition) {
+                const auto start = offset + partition * size;
+                const auto length = std::min(size, lengthInSamples - start);
+                std::fill(transform.begin(), transform.end(), 0.0f);
+                juce::FloatVectorOperations::copyWithMultiply(transform.data(), audio.getReadPointer(channel, start), gain, length);
+                fft.performRealOnlyForwardTransform(transform.data(), true);
+                std::copy(transform.begin(), transform.begin() + numBins * 2, spectra.begin() + partition * numBins * 2);
+            }
+        }
+        segments.push_back(std::move(segment));
+        offset = end;
+    }
+}
@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    ImpulseResponse.h
+    Created: 19 Oct 2026 10:41:43am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+    An impulse response cut up and transformed once for ConvolutionReverb, then shared by every reverb using it. The
+    first DIRECT_TAPS samples are kept as they are for direct convolution. The rest is split into segments of uniform
+    partitions, each segment's partitions 4x the length of the last one's up to MAX_PARTITION_SIZE. Every segment
+    starts exactly one of its own partitions into the response, which is what lets the reverb run the long ones at
+    their own block length without adding latency. The MAX_PARTITION_SIZE one starts two in, so in an audio callback
+    it can be worked out a whole block ahead of when it's due.
+ */
+class ImpulseResponse {
+public:
+    static constexpr int DIRECT_TAPS = 128;
+    static constexpr int MAX_PARTITION_SIZE = 8192;
+
+    struct Segment {
+        int partitionSize;
+        // where the segment starts in the response, counted in its own partitions
+        int firstPartition;
+        int numPartitions;
+        // per channel, numPartitions spectra of partitionSize + 1 interleaved complex bins, transformed at twice the
+        // partition size
+        std::vector<std::vector<float>> spectra;
+    };
+
+    // the file decoded and resampled to sampleRate, shared with everything else asking for the same file at the same
+    // rate for as long as any of them holds on to it. Throws if the file can't be read
+    static std::shared_ptr<const ImpulseResponse> load(const std::string& filePath, double sampleRate);
+    // a generated stand-in for the file, shared the same way, see SyntheticSamples::impulseResponse
+    static std::shared_ptr<const ImpulseResponse> synthetic(double sampleRate);
+
+    // one or two channels at the rate it will be convolved at. The silent end is trimmed and the channels are scaled
+    // together to unit energy on average, so a reverb's wet level means about the same whatever the response
+    ImpulseResponse(juce::AudioBuffer<float> audio, std::size_t identity);
+
+    int getNumChannels() const { return numChannels; }
+    int getLengthInSamples() const { return lengthInSamples; }
+    std::size_t getIdentity() const { return identity; }
+
+    int getNumDirectTaps() const { return directTaps.getNumSamples(); }
+    const float* getDirectTaps(int channel) const { return directTaps.getReadPointer(channel); }
+    const std::vector<Segment>& getSegments() const { return segments; }
+
+private:
+    int numChannels;
+    int lengthInSamples;
+    std::size_t identity;
+    juce::AudioBuffer<float> directTaps;
+    std::vector<Segment> segments;
+};
@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    LoudnessMeter.cpp
+    Created: 19 Oct 2026 10:08:13am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "LoudnessMeter.h"
+#include <cmath>
+#include <limits>
+
+// the analog prototypes behind the BS.1770 K-weighting filters, so they can be built at any sample rate
+static const double shelfFrequency = 1681.974450955533;
+static const double shelfGainDb = 3.999843853973347;
+static const double shelfQ = 0.7071752369554196;
+static const double highPassFrequency = 38.13547087602444;
+static const double highPassQ = 0.5003270373238773;
+
+static double energyToLoudness(double energy) {
+    return -0.691 + 10.0 * std::log10(energy);
+}
+
+LoudnessMeter::LoudnessMeter(double sampleRate) : weighted(CHUNK_SIZE), hopLength(static_cast<int>(std::round(sampleRate * 0.1))), binEnergy(static_cast<size_t>((HISTOGRAM_CEILING - ABSOLUTE_GATE) * BINS_PER_LU), 0.0), binCount(binEnergy.size(), 0) {
+    const double shelfK = std::tan(juce::MathConstants<double>::pi * shelfFrequency / sampleRate);
+    const double shelfVh = std::pow(10.0, shelfGainDb / 20.0);
+    const double shelfVb = std::pow(shelfVh, 0.4996667741545416);
+    const double highPassK = std::tan(juce::MathConstants<double>::pi * highPassFrequency / sampleRate);
+    // Coefficients divides everything by a0, the high pass's numerator has to be 1, -2, 1 after that
+    const double highPassA0 = 1.0 + highPassK / highPassQ + highPassK * highPassK;
+
+    for (int channel = 0; channel < CHANNELS; ++channel) {
+        shelfFilters[channel].coefficients = new juce::dsp::IIR::Coefficients<float>(
+            static_cast<float>(shelfVh + shelfVb * shelfK / shelfQ + shelfK * shelfK),
+            static_cast<float>(2.0 * (shelfK * shelfK - shelfVh)),
+            static_cast<float>(shelfVh - shelfVb * shelfK / shelfQ + shelfK * shelfK),
+            static_cast<float>(1.0 + shelfK / shelfQ + shelfK * shelfK),
+            static_cast<float>(2.0 * (shelfK * shelfK - 1.0)),
+            static_cast<float>(1.0 - shelfK / shelfQ + shelfK * shelfK));
+        highPassFilters[channel].coefficients = new juce::dsp::IIR::Coefficients<float>(
+            static_cast<float>(highPassA0),
+            static_cast<float>(-2.0 * highPassA0),
+            static_cast<float>(highPassA0),
+            static_cast<float>(highPassA0),
+            static_cast<float>(2.0 * (highPassK * highPassK - 1.0)),
+            static_cast<float>(1.0 - highPassK / highPassQ + highPassK * highPassK));
+    }
+    reset();
+}
+
+void LoudnessMeter::reset() {
+    for (int channel = 0; channel < CHANNELS; ++channel) {
+        shelfFilters[channel].reset();
+        highPassFilters[channel].reset();
+    }
+    hopPosition = 0;
+    hopEnergy = 0.0;
+    recentHops.fill(0.0);
+    hopsSeen = 0;
+    std::fill(binEnergy.begin(), binEnergy.end(), 0.0);
+    std::fill(binCount.begin(), binCount.end(), 0);
+}
+
+void LoudnessMeter::process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) {
+    const int numChannels = std::min(CHANNELS, buffer.getNumChannels());
+
+    // chunks never cross a hop boundary, so each hop's energy is complete when its last chunk is summed
+    for (int position = 0; position < numSamples; ) {
+        const int length = std::min({CHUNK_SIZE, numSamples - position, hopLength - hopPosition});
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+            juce::FloatVectorOperations::copy(weighted.data(), buffer.getReadPointer(channel, startSample + position), length);
+            float* channels[] = {weighted.data()};
+            juce::dsp::AudioBlock<float> block(channels, 1, static_cast<size_t>(length));
+            juce::dsp::ProcessContextReplacing<float> context(block);
+            shelfFilters[channel].process(context);
+            highPassFilters[channel].process(context);
+
+            // a plain reduction the compiler vectorises, FloatVectorOperations has nothing that sums
+            float sum = 0.0f;
+            for (int i = 0; i < length; ++i) {
+                sum += weighted[i] * weighted[i];
+            }
+            hopEnergy += sum;
+        }
+
+        position += length;
+        hopPosition += length;
+        if (hopPosition == hopLength) {
+            recentHops[hopsSeen % HOPS_PER_BLOCK] = hopEnergy;
+            hopsSeen++;
+            hopEnergy = 0.0;
+            hopPosition = 0;
+            if (hopsSeen >= HOPS_PER_BLOCK) {
+                double blockEnergy = 0.0;
+                for (auto energy : recentHops) {
+                    blockEnergy += energy;
+                }
+                addBlock(blockEnergy / (HOPS_PER_BLOCK * hopLength));
+            }
+        }
+    }
+}
+
+void LoudnessMeter::addBlock(double energy) {
+    const double loudness = energyToLoudness(energy);
+    if (!(loudness >= ABSOLUTE_GATE)) {
+        return;
+    }
+    const auto bin = std::min(binEnergy.size() - 1, static_cast<size_t>((loudness - ABSOLUTE_GATE) * BINS_PER_LU));
+    binEnergy[bin] += energy;
+    binCount[bin]++;
+}
+
+double LoudnessMeter::getIntegratedLoudness() const {
+    double totalEnergy = 0.0;
+    juce::int64 totalCount = 0;
+    for (size_t bin = 0; bin < binEnergy.size(); ++bin) {
+        totalEnergy += binEnergy[bin];
+        totalCount += binCount[bin];
+    }
+    if (totalCount == 0) {
+        return -std::numeric_limits<double>::infinity();
+    }
+
+    const double threshold = energyToLoudness(totalEnergy / totalCount) + RELATIVE_GATE;
+    double gatedEnergy = 0.0;
+    juce::int64 gatedCount = 0;
+    for (size_t bin = 0; bin < binEnergy.size(); ++bin) {
+        if (binCount[bin] > 0 && energyToLoudness(binEnergy[bin] / binCount[bin]) >= threshold) {
+            gatedEnergy += binEnergy[bin];
+            gatedCount += binCount[bin];
+        }
+    }
+    return gatedCount > 0 ? energyToLoudness(gatedEnergy / gatedCount) : -std::numeric_limits<double>::infinity();
+}
@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    LoudnessMeter.h
+    Created: 19 Oct 2026 10:08:13am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+
+/*
+    Integrated loudness (LUFS) of a stereo signal as ITU-R BS.1770 measures it: K-weighted, in 400ms blocks that
+    overlap by 75%, gated at -70 LUFS and then 10 LU under the ungated result.
+
+    Blocks go into a 0.1 LU histogram rather than a list, so the meter is a fixed size however long it runs and
+    process never allocates, it can be fed a window or a device block at a time.
+ */
+class LoudnessMeter {
+public:
+    LoudnessMeter(double sampleRate);
+
+    void process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+    void reset();
+
+    // -infinity until a block has made it past the gate
+    double getIntegratedLoudness() const;
+
+private:
+    static constexpr int CHANNELS = 2;
+    static constexpr int CHUNK_SIZE = 256;
+    static constexpr int HOPS_PER_BLOCK = 4;
+    static constexpr double ABSOLUTE_GATE = -70.0;
+    static constexpr double RELATIVE_GATE = -10.0;
+    static constexpr double HISTOGRAM_CEILING = 10.0;
+    static constexpr int BINS_PER_LU = 10;
+
+    std::array<juce::dsp::IIR::Filter<float>, CHANNELS> shelfFilters;
+    std::array<juce::dsp::IIR::Filter<float>, CHANNELS> highPassFilters;
+    std::vector<float> weighted;
+
+    int hopLength;
+    int hopPosition = 0;
+    double hopEnergy = 0.0;
+    std::array<double, HOPS_PER_BLOCK> recentHops {};
+    int hopsSeen = 0;
+
+    std::vector<double> binEnergy;
+    std::vector<juce::int64> binCount;
+
+    void addBlock(double energy);
+};
@@ -23,12 +23,14 @@ juce::MidiMessageSequence MIDIRenderer::toMidiSequence(std::vector<Note> notes)
         double startTimeInSeconds = note.startTimeInBeats * (60.0 / bpm);
         double durationInSeconds = note.durationInBeats * (60.0 / bpm);
         
-        auto startSample = static_cast<int>(startTimeInSeconds * sampleRate);
-        auto endSample = startSample + static_cast<int>(durationInSeconds * sampleRate);
+        // 64 bit, a stream passes 2^31 samples after about twelve hours at 48k. Timestamps are doubles so they hold
+        // whole samples exactly far past that
+        auto startSample = static_cast<juce::int64>(startTimeInSeconds * sampleRate);
+        auto endSample = startSample + static_cast<juce::int64>(durationInSeconds * sampleRate);
         
         
-        sequence.addEvent(juce::MidiMessage::noteOn(1, note.midiNoteNumber, note.velocity), startSample);
-        sequence.addEvent(juce::MidiMessage::noteOff(1, note.midiNoteNumber), endSample);
+        sequence.addEvent(juce::MidiMessage::noteOn(1, note.midiNoteNumber, note.velocity), static_cast<double>(startSample));
+        sequence.addEvent(juce::MidiMessage::noteOff(1, note.midiNoteNumber), static_cast<double>(endSample));
     }
     return sequence;
 }
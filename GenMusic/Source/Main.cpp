@@ -1,150 +1,133 @@
 #include <JuceHeader.h>
 #include <iostream>
 #include <string>
-#include <sstream>
-#include <random>
-#include <chrono>
-#include <functional>
-#include <vector>
-#include <utility>
 #include <fmt/core.h>
-#include <fmt/ranges.h>
-#include <numeric>
-#include "Note.h"
-#include "Song.h"
-#include "Voices.h"
-#include "SampleProcessor.h"
-#include "RepitchingSingleInstrumentSampleProcessor.h"
-#include "MultiInstrumentSampleProcessor.h"
 #include "Utilities.h"
-#include "WidthProcessor.h"
-#include "GrooveTrackGenerator.h"
-#include "ChordalGenerator.h"
-#include "MelodicGenerator.h"
-#include "AudioProcessingBus.h"
-#include "MelodicComponentsEffectProcessor.h"
-#include "NoteGenerator.h"
-#include "DrumsEffectProcessor.h"
-
-double SAMPLE_RATE = 44100.0;
-
-
-// the chance of each potential subdivision being played
-const std::vector<double> kickWeights = {1.0, 0.5, 0.5, 0.5, 0.7, 0.6, 0.5, 0.5};
-const std::vector<double> hitWeights = {0.15, 0.15, 0.5, 0.15, 0.15, 0.15, 0.8, 0.15};
+#include "RenderSettings.h"
+#include "SampleBank.h"
+#include "RenderEngine.h"
+#include "RenderDaemon.h"
+#include "AllocationTracker.h"
+#include "MultiInstrumentSampleProcessor.h"
+#include "SyntheticSamples.h"
 
-// TODO bugs: some big jumps in melodes, normalize the note ranges, compression, audio bus, move gain from synth voice to a chain, maybe even abstract out the synthesisers at this point, match output volume to input volume, multiband compression, clip right at the end of a track??, beginning and end are quieter??
+// TODO bugs: some big jumps in melodes, normalize the note ranges, audio bus, move gain from synth voice to a chain, maybe even abstract out the synthesisers at this point, beginning and end are quieter??
+// every mode also takes --assert-voice-allocations, which aborts if a voice allocates while rendering (needs a build
+// with GENMUSIC_TRACK_ALLOCATIONS=1, which also prints per stage allocation counts after each render) and
+// --synthetic-samples, which renders with generated tones so the sample files aren't needed, and --compact-samples,
+// which keeps the samples in memory as 16 bit, --repitch-cache-mb=size, which bounds each instrument's repitched notes,
+// --note-cache-mb=size, which bounds the rendered notes kept between songs (0 turns it off), --normalise-samples,
+// which brings every sample file to the same peak as it loads, and --impulse-response=file, which reverbs the aux
+// return by convolving with the file instead of the algorithmic reverb
+// --swap-drums renders the song again with the synthetic drum kit, only the drum bus is re-rendered
+// usage: GenMusic [seed] [--bank=file] [--preview] [--sample-rate=rate]
+//        GenMusic bake <file> [--preview] [--sample-rate=rate]
+//        GenMusic stream <seed> <bars> <file> [--bank=file] [--preview] [--sample-rate=rate]
+//        GenMusic play <seed> <bars> [--simulate] [--bank=file] [--preview] [--sample-rate=rate]
+//        GenMusic daemon [--bank=file] [--preview] [--sample-rate=rate]
 int main(int argc, char *argv[]) {
+    juce::ArgumentList args(argc, argv);
+    const auto workingDirectory = juce::File::getCurrentWorkingDirectory();
     
-    std::vector<unsigned char> seed;
-    if (argc > 1) {
-        seed = generateRandomBytes(250, argv[1]);
-    } else {
-        seed = generateRandomBytes(250, "the next best thing");
+    // final renders at 48k unless asked otherwise, previews at half that with cheaper repitching and effects
+    auto settings = args.containsOption("--preview") ? RenderSettings::forPreview() : RenderSettings::forFinal();
+    if (args.containsOption("--sample-rate")) {
+        settings.sampleRate = args.getValueForOption("--sample-rate").getDoubleValue();
+    }
+    settings.useSyntheticSamples = args.containsOption("--synthetic-samples");
+    settings.compactSampleStorage = args.containsOption("--compact-samples");
+    settings.normaliseSamples = args.containsOption("--normalise-samples");
+    if (args.containsOption("--repitch-cache-mb")) {
+        settings.repitchCacheBudgetBytes = static_cast<std::size_t>(args.getValueForOption("--repitch-cache-mb").getLargeIntValue()) * 1024 * 1024;
+    }
+    if (args.containsOption("--note-cache-mb")) {
+        settings.noteCacheBudgetBytes = static_cast<std::size_t>(args.getValueForOption("--note-cache-mb").getLargeIntValue()) * 1024 * 1024;
+    }
+    if (args.containsOption("--impulse-response")) {
+        settings.impulseResponsePath = workingDirectory.getChildFile(args.getValueForOption("--impulse-response")).getFullPathName().toStdString();
     }
     
-    int index = 0;
-    
-    const double bpm = 60 + (4 * (seed[index++] % 16));
-    
-    const auto isMajor = static_cast<int>(seed[index++]) % 2 == 0;
-    
-    const auto rootStart = index++;
-    const auto slice = std::vector<unsigned char>(seed.begin()+rootStart, seed.begin()+rootStart+4);
-    ChordalGenerator chordalGenerator(slice, isMajor);
-    const auto roots = chordalGenerator.getRoots();
-    
-    
-    const auto chords = chordalGenerator.getChords(roots);
-    
-    MelodicGenerator melodyGenerator(std::vector<unsigned char>(seed.begin()+index, seed.end()), roots, chords, isMajor);
-
-    const auto allMelodyNotes = melodyGenerator.generate();
-    
-    std::vector<Note> allChordNotes;
-    
-    
-    for (const auto& chord: chords) {
-        for (const auto& note: chord.getNotes()) {
-            allChordNotes.push_back(note);
+    if (args.containsOption("--assert-voice-allocations")) {
+        if (!AllocationTracker::isEnabled()) {
+            fmt::println("--assert-voice-allocations needs a build with GENMUSIC_TRACK_ALLOCATIONS=1");
+            return 1;
         }
+        AllocationTracker::setFailOnVoiceAllocation(true);
     }
-
-    GrooveTrackGenerator kickGenerator(0, std::vector<unsigned char>(seed.begin()+allMelodyNotes.size(), seed.end()), kickWeights, 4.0, {0.5}, {3});
-    std::vector<Note> kickNotes = kickGenerator.generate();
-    GrooveTrackGenerator hitGenerator(1, std::vector<unsigned char>(seed.begin()+allMelodyNotes.size()+kickNotes.size(), seed.end()), hitWeights, 4.0, {0.5}, {1});
-    std::vector<Note> hitNotes = hitGenerator.generate();
     
-    for (auto note : hitNotes) {
-        fmt::print("start {} {} {} {}\n", note.startTimeInBeats, note.velocity, note.durationInBeats, note.midiNoteNumber);
+    if (args.size() > 0 && args[0].text == "bake") {
+        if (args.size() < 2) {
+            fmt::println("usage: GenMusic bake <file>");
+            return 1;
+        }
+        
+        RenderEngine::bakeSampleBank(workingDirectory.getChildFile(args[1].text), settings);
+        return 0;
     }
     
-    // TODO the note parameter doesn't really work right
-    std::shared_ptr<SampleProcessor> melodySampleProcessor = std::make_shared<RepitchingSingleInstrumentSampleProcessor>("/Users/benjaminconn/workspace/lnrz/gen-music-script/sounds/JPIANO-C4.mp3", 36, allMelodyNotes);
-    
-    std::shared_ptr<SampleProcessor> chordSampleProcessor = std::make_shared<RepitchingSingleInstrumentSampleProcessor>("/Users/benjaminconn/workspace/lnrz/gen-music-script/sounds/JPIANO-C2.mp3", 36, allChordNotes);
-    
-    std::map<int, std::string> drumSamples = {{0, "/Users/benjaminconn/workspace/lnrz/gen-music-script/sounds/samples/kick/KICK - nudy.wav"}, {1,"/Users/benjaminconn/workspace/lnrz/gen-music-script/sounds/samples/perc/PERC - stick.wav"}};
-    
-    std::shared_ptr<SampleProcessor> drumSampleProcessor = std::make_shared<MultiInstrumentSampleProcessor>(drumSamples);
-    
-    juce::Synthesiser melodySynth;
-    melodySynth.setCurrentPlaybackSampleRate(SAMPLE_RATE);
-    melodySynth.setNoteStealingEnabled(true);
-    for (int i = 0; i < 3; ++i) {
-        // 4 potential notes played at once
-        melodySynth.addVoice(new SampleVoice(melodySampleProcessor, i, 1.0f));
+    std::shared_ptr<SampleBank> bank;
+    if (args.containsOption("--bank")) {
+        bank = std::make_shared<SampleBank>(workingDirectory.getChildFile(args.getValueForOption("--bank")));
     }
-    melodySynth.addSound(new DefaultSynthSound());
     
-    juce::Synthesiser chordsSynth;
-    chordsSynth.setCurrentPlaybackSampleRate(SAMPLE_RATE);
-    chordsSynth.setNoteStealingEnabled(true);
-    for (int i = 0; i < 6; ++i) {
-        chordsSynth.addVoice(new SampleVoice(chordSampleProcessor, i, 0.8f));
+    if (args.size() > 0 && args[0].text == "daemon") {
+        // stdout carries the protocol so the render chatter has to go
+        verboseLogging = false;
+        RenderEngine engine(settings, bank);
+        RenderDaemon daemon(engine);
+        daemon.run(std::cin, std::cout);
+        return 0;
     }
-    chordsSynth.addSound(new DefaultSynthSound());
     
-    juce::Synthesiser drumSynth;
-    drumSynth.setCurrentPlaybackSampleRate(SAMPLE_RATE);
-    drumSynth.setNoteStealingEnabled(true);
-    for (int i = 0; i < 4; ++i) {
-        drumSynth.addVoice(new SampleVoice(drumSampleProcessor, i, 0.5f));
+    if (args.size() > 0 && args[0].text == "stream") {
+        if (args.size() < 4) {
+            fmt::println("usage: GenMusic stream <seed> <bars> <file>");
+            return 1;
+        }
+        
+        RenderEngine engine(settings, bank);
+        const auto timings = engine.renderStream(args[1].text.toStdString(), workingDirectory.getChildFile(args[3].text), args[2].text.getIntValue());
+        fmt::println("Streamed {} bars in {:.0f}ms", args[2].text.getIntValue(), timings.totalMs);
+        return 0;
     }
-    drumSynth.addSound(new DefaultSynthSound());
     
-    auto melodicProcessor = MelodicComponentEffectProcessor(SAMPLE_RATE);
-//    auto melodicProcessor = DrumsEffectProcessor();
-    auto drumsProcessor = DrumsEffectProcessor();
-
-    auto song = Song(bpm, SAMPLE_RATE);
-    std::vector<std::pair<int, std::pair<NoteGenerator*, juce::Synthesiser*>>> noteGenerators;
-    noteGenerators.push_back(std::make_pair(0, std::make_pair(&melodyGenerator, &melodySynth)));
-    noteGenerators.push_back(std::make_pair(0, std::make_pair(&chordalGenerator, &chordsSynth)));
-    noteGenerators.push_back(std::make_pair(1, std::make_pair(&hitGenerator, &drumSynth)));
-    noteGenerators.push_back(std::make_pair(1, std::make_pair(&kickGenerator, &drumSynth)));
-    
-    std::map<int, AudioProcessingBus> busses;
-    std::map<int, EffectProcessor*> effects;
-    
-    
-    busses.emplace(0, AudioProcessingBus(SAMPLE_RATE));
-    busses.emplace(1, AudioProcessingBus(SAMPLE_RATE));
+    if (args.size() > 0 && args[0].text == "play") {
+        if (args.size() < 3) {
+            fmt::println("usage: GenMusic play <seed> <bars> [--simulate]");
+            return 1;
+        }
+        
+        RenderEngine engine(settings, bank);
+        const auto stats = engine.play(args[1].text.toStdString(), args[2].text.getIntValue(), !args.containsOption("--simulate"));
+        fmt::println("callbacks={} xruns={} device_xruns={} dropped_events={} budget_ms={:.3f} p50_ms={:.3f} p90_ms={:.3f} p99_ms={:.3f} max_ms={:.3f}",
+                     stats.callbacks, stats.xruns, stats.deviceXruns, stats.droppedEvents, stats.budgetMs, stats.p50Ms, stats.p90Ms, stats.p99Ms, stats.maxMs);
+        return 0;
+    }
     
-    effects[0] = &melodicProcessor;
-    effects[1] = &drumsProcessor;
+    std::string seedString = "the next best thing";
+    if (args.size() > 0 && !args[0].isOption()) {
+        seedString = args[0].text.toStdString();
+    }
     
+    RenderEngine engine(settings, bank);
     
     juce::File outputFile("/Users/benjaminconn/workspace/lnrz/gen-music-script/sounds/output-v3.wav");
     juce::File midiFile("/Users/benjaminconn/workspace/lnrz/gen-music-script/sounds/output-v3.midi");
-    auto buffer = song.generateSong(noteGenerators, busses, effects);
-    song.renderToFile(outputFile, buffer);
-    std::vector<NoteGenerator*> allGenerators;
-    for (auto& noteGenerator: noteGenerators) {
-        allGenerators.push_back(noteGenerator.second.first);
+    engine.render(seedString, outputFile, midiFile);
+    
+    if (args.containsOption("--swap-drums")) {
+        std::map<int, juce::AudioBuffer<float>> drums;
+        drums[0] = SyntheticSamples::kick(settings.sampleRate);
+        drums[1] = SyntheticSamples::hit(settings.sampleRate);
+        std::size_t identity = 0;
+        hashCombine(identity, SyntheticSamples::VERSION);
+        hashCombine(identity, settings.sampleRate);
+        engine.setDrumSamples(std::make_shared<MultiInstrumentSampleProcessor>(std::move(drums), identity, settings.compactSampleStorage));
+        
+        const auto hitsBefore = engine.getStemCacheHits();
+        const auto missesBefore = engine.getStemCacheMisses();
+        const auto timings = engine.render(seedString, outputFile.getSiblingFile(outputFile.getFileNameWithoutExtension() + "-swapped-drums.wav"), juce::File());
+        fmt::println("Re-rendered with the synthetic drums in {:.0f}ms, {} stems reused and {} rendered", timings.totalMs, engine.getStemCacheHits() - hitsBefore, engine.getStemCacheMisses() - missesBefore);
     }
-    auto midiSequence = song.generateMidi(allGenerators);
-    song.renderToMidiFile(midiFile, midiSequence);
     return 0;
 }
-
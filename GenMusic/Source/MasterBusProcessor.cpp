@@ -0,0 +1,189 @@
+/*
+  ==============================================================================
+
+    MasterBusProcessor.cpp
+    Created: 19 Oct 2026 10:08:13am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "MasterBusProcessor.h"
+#include <cmath>
+#include "Utilities.h"
+
+MasterBusProcessor::MasterBusProcessor(double sampleRate) : sampleRate(sampleRate), meter(sampleRate) {
+    ceiling = juce::Decibels::decibelsToGain(CEILING_DB);
+    // the history has to hold a whole interpolation window behind each new sample
+    lookahead = std::max(TAPS_PER_PHASE, static_cast<int>(std::round(LOOKAHEAD_SECONDS * sampleRate)));
+    // the interpolator looks TAPS_PER_PHASE / 2 samples ahead of the sample it's checking
+    latency = TAPS_PER_PHASE / 2 + lookahead - 1;
+    releaseCoefficient = static_cast<float>(1.0 - std::exp(-1.0 / (RELEASE_SECONDS * sampleRate)));
+
+    // a hann windowed sinc for each phase, evaluated between the window's two middle samples
+    interpolationTaps.resize(OVERSAMPLING * TAPS_PER_PHASE);
+    const double centre = TAPS_PER_PHASE / 2 - 1;
+    for (int phase = 0; phase < OVERSAMPLING; ++phase) {
+        for (int tap = 0; tap < TAPS_PER_PHASE; ++tap) {
+            const double x = tap - centre - static_cast<double>(phase) / OVERSAMPLING;
+            const double sinc = x == 0.0 ? 1.0 : std::sin(juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+            const double window = 0.5 + 0.5 * std::cos(juce::MathConstants<double>::pi * x / (TAPS_PER_PHASE / 2));
+            interpolationTaps[phase * TAPS_PER_PHASE + tap] = static_cast<float>(sinc * window);
+        }
+    }
+
+    history.assign(CHANNELS, std::vector<float>(latency + CHUNK_SIZE, 0.0f));
+    gains.resize(CHUNK_SIZE);
+    minimumValues.resize(lookahead + 1);
+    minimumPositions.resize(lookahead + 1);
+    averageHistory.resize(lookahead);
+    reset();
+}
+
+void MasterBusProcessor::reset() {
+    meter.reset();
+    normalisationGain.reset(sampleRate, STREAMED_GAIN_RAMP_SECONDS);
+    normalisationGain.setCurrentAndTargetValue(1.0f);
+
+    for (auto& channel : history) {
+        std::fill(channel.begin(), channel.end(), 0.0f);
+    }
+    minimumFront = 0;
+    minimumSize = 0;
+    position = 0;
+    releasedGain = 1.0f;
+    std::fill(averageHistory.begin(), averageHistory.end(), 1.0f);
+    averageIndex = 0;
+    averageSum = lookahead;
+}
+
+float MasterBusProcessor::gainForLoudness(double loudness) {
+    // nothing has made it past the meter's gate yet, or it's silence, leave it alone
+    if (!std::isfinite(loudness)) {
+        return 1.0f;
+    }
+    return juce::Decibels::decibelsToGain(static_cast<float>(std::min(MAX_GAIN_DB, TARGET_LOUDNESS - loudness)));
+}
+
+void MasterBusProcessor::processOffline(juce::AudioBuffer<float>& buffer) {
+    reset();
+    const int numSamples = buffer.getNumSamples();
+
+    meter.process(buffer, 0, numSamples);
+    normalisationGain.setCurrentAndTargetValue(gainForLoudness(meter.getIntegratedLoudness()));
+    logVerbose("Master measured {} LUFS, normalising by {} dB", meter.getIntegratedLoudness(), juce::Decibels::gainToDecibels(normalisationGain.getTargetValue()));
+    normalisationGain.applyGain(buffer, numSamples);
+
+    // limit a chunk at a time and write each one back latency samples earlier than it went in, then flush the
+    // limiter with silence for the end of the buffer
+    juce::AudioBuffer<float> chunk(buffer.getNumChannels(), CHUNK_SIZE);
+    for (int start = 0; start < numSamples + latency; start += CHUNK_SIZE) {
+        const int length = std::min(CHUNK_SIZE, numSamples + latency - start);
+        chunk.clear();
+        if (start < numSamples) {
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
+                chunk.copyFrom(channel, 0, buffer, channel, start, std::min(length, numSamples - start));
+            }
+        }
+
+        limit(chunk, 0, length);
+
+        const int skip = std::max(0, latency - start);
+        const int destination = start + skip - latency;
+        const int count = std::min(length - skip, numSamples - destination);
+        for (int channel = 0; count > 0 && channel < buffer.getNumChannels(); ++channel) {
+            buffer.copyFrom(channel, destination, chunk, channel, skip, count);
+        }
+    }
+}
+
+void MasterBusProcessor::process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) {
+    meter.process(buffer, startSample, numSamples);
+    normalisationGain.setTargetValue(gainForLoudness(meter.getIntegratedLoudness()));
+
+    if (normalisationGain.isSmoothing()) {
+        // applyGain only works from the start of a buffer, so step the ramp by hand
+        for (int i = 0; i < numSamples; ++i) {
+            const float gain = normalisationGain.getNextValue();
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
+                buffer.getWritePointer(channel)[startSample + i] *= gain;
+            }
+        }
+    } else {
+        buffer.applyGain(startSample, numSamples, normalisationGain.getTargetValue());
+    }
+
+    limit(buffer, startSample, numSamples);
+}
+
+void MasterBusProcessor::limit(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) {
+    const int numChannels = std::min(CHANNELS, buffer.getNumChannels());
+    float* channels[CHANNELS] = {};
+    for (int start = 0; start < numSamples; start += CHUNK_SIZE) {
+        for (int channel = 0; channel < numChannels; ++channel) {
+            channels[channel] = buffer.getWritePointer(channel, startSample + start);
+        }
+        limitChunk(channels, numChannels, std::min(CHUNK_SIZE, numSamples - start));
+    }
+}
+
+void MasterBusProcessor::limitChunk(float* const* channels, int numChannels, int numSamples) {
+    std::fill(gains.begin(), gains.begin() + numSamples, 0.0f);
+
+    // the highest true peak across the channels for each sample, into gains for now
+    for (int channel = 0; channel < numChannels; ++channel) {
+        auto& samples = history[channel];
+        juce::FloatVectorOperations::copy(samples.data() + latency, channels[channel], numSamples);
+
+        for (int i = 0; i < numSamples; ++i) {
+            // the window ends on the newest sample and checks the stretch just after its middle
+            const float* window = samples.data() + latency + i - (TAPS_PER_PHASE - 1);
+            float peak = gains[i];
+            for (int phase = 0; phase < OVERSAMPLING; ++phase) {
+                const float* taps = interpolationTaps.data() + phase * TAPS_PER_PHASE;
+                float value = 0.0f;
+                for (int tap = 0; tap < TAPS_PER_PHASE; ++tap) {
+                    value += taps[tap] * window[tap];
+                }
+                peak = std::max(peak, std::abs(value));
+            }
+            gains[i] = peak;
+        }
+    }
+
+    for (int i = 0; i < numSamples; ++i) {
+        gains[i] = nextGain(gains[i] > ceiling ? ceiling / gains[i] : 1.0f);
+    }
+
+    // the delayed input lines up with the gain, then keep the tail of the history for the next chunk
+    for (int channel = 0; channel < numChannels; ++channel) {
+        auto& samples = history[channel];
+        juce::FloatVectorOperations::multiply(channels[channel], samples.data(), gains.data(), numSamples);
+        std::copy(samples.begin() + numSamples, samples.begin() + numSamples + latency, samples.begin());
+    }
+}
+
+float MasterBusProcessor::nextGain(float required) {
+    const int capacity = static_cast<int>(minimumValues.size());
+    while (minimumSize > 0 && minimumValues[(minimumFront + minimumSize - 1) % capacity] >= required) {
+        minimumSize--;
+    }
+    const int back = (minimumFront + minimumSize) % capacity;
+    minimumValues[back] = required;
+    minimumPositions[back] = position;
+    minimumSize++;
+    while (minimumPositions[minimumFront] <= position - lookahead) {
+        minimumFront = (minimumFront + 1) % capacity;
+        minimumSize--;
+    }
+    position++;
+
+    // drops straight to the held minimum and lets go of it over the release
+    const float minimum = minimumValues[minimumFront];
+    releasedGain = minimum < releasedGain ? minimum : releasedGain + (minimum - releasedGain) * releaseCoefficient;
+
+    averageSum += releasedGain - averageHistory[averageIndex];
+    averageHistory[averageIndex] = releasedGain;
+    averageIndex = (averageIndex + 1) % lookahead;
+    return static_cast<float>(averageSum / lookahead);
+}
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    MasterBusProcessor.h
+    Created: 19 Oct 2026 10:08:13am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <vector>
+#include "LoudnessMeter.h"
+
+/*
+    The last stage after the busses are mixed: a gain that brings the mix to TARGET_LOUDNESS, then a lookahead
+    limiter that keeps the true (inter-sample) peak under CEILING_DB so the float wav never goes over full scale.
+
+    A whole song is measured first and gets one fixed gain, that's the single extra pass. Streamed audio can't be
+    measured ahead, so the gain follows the loudness of what's gone past, slowly enough not to pump, and the limiter
+    catches anything it lets through.
+
+    The limiter delays the audio by getLatencyInSamples. processOffline takes care of that itself, streamed callers
+    have to drop that many samples from the start and flush with silence at the end.
+ */
+class MasterBusProcessor {
+public:
+    static constexpr double TARGET_LOUDNESS = -14.0;
+    static constexpr float CEILING_DB = -1.0f;
+
+    MasterBusProcessor(double sampleRate);
+
+    int getLatencyInSamples() const { return latency; }
+
+    // measures the buffer then normalises and limits it in place, it comes back lined up with the input
+    void processOffline(juce::AudioBuffer<float>& buffer);
+    // in place, allocation free, the output is getLatencyInSamples behind the input
+    void process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+    void reset();
+
+    // what the input measured so far
+    double getIntegratedLoudness() const { return meter.getIntegratedLoudness(); }
+
+private:
+    static constexpr int CHANNELS = 2;
+    static constexpr int CHUNK_SIZE = 256;
+    // true peak is looked for at four times the sample rate, the first phase is the sample itself
+    static constexpr int OVERSAMPLING = 4;
+    static constexpr int TAPS_PER_PHASE = 12;
+    static constexpr double LOOKAHEAD_SECONDS = 0.005;
+    static constexpr double RELEASE_SECONDS = 0.1;
+    static constexpr double MAX_GAIN_DB = 20.0;
+    static constexpr double STREAMED_GAIN_RAMP_SECONDS = 2.0;
+
+    double sampleRate;
+    LoudnessMeter meter;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> normalisationGain;
+
+    float ceiling;
+    int lookahead;
+    int latency;
+    float releaseCoefficient;
+    std::vector<float> interpolationTaps;
+
+    // per channel: the last latency samples of input followed by the chunk being limited
+    std::vector<std::vector<float>> history;
+    std::vector<float> gains;
+
+    // sliding minimum of the required gain over the lookahead, a monotonic queue in ring buffers
+    std::vector<float> minimumValues;
+    std::vector<juce::int64> minimumPositions;
+    int minimumFront = 0;
+    int minimumSize = 0;
+    juce::int64 position = 0;
+
+    float releasedGain = 1.0f;
+    // moving average over the lookahead, so the gain is already down when the peak comes out of the delay
+    std::vector<float> averageHistory;
+    int averageIndex = 0;
+    double averageSum = 0.0;
+
+    static float gainForLoudness(double loudness);
+    void limit(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+    void limitChunk(float* const* channels, int numChannels, int numSamples);
+    float nextGain(float required);
+};
@@ -10,14 +10,24 @@
 
 #pragma once
 #include "EffectProcessor.h"
-#include "WidthProcessor.h"
+#include "StereoMatrixChain.h"
+#include "RenderSettings.h"
+#include "MultibandCompressor.h"
 
 
 class MelodicComponentEffectProcessor : public EffectProcessor {
 public:
-    MelodicComponentEffectProcessor(double sampleRate);
+    MelodicComponentEffectProcessor(const RenderSettings& settings);
     
     void process(juce::AudioBuffer<float>& buffer) override;
+    void reset() override;
+    std::size_t getConfigurationHash() const override { return configurationHash; }
 private:
-    juce::dsp::ProcessorChain<juce::dsp::Gain<float>, WidthProcessor, juce::dsp::Chorus<float>, juce::dsp::Reverb> processor;
+    // the chorus and reverb are on the shared aux return, see AuxReturnEffectProcessor
+    // gain then width, one pass over the buffer after the compressor
+    StereoMatrixChain stages;
+    // runs ahead of the chain so the sends get an even level, previews skip it
+    MultibandCompressor compressor;
+    bool isCompressorBypassed;
+    std::size_t configurationHash = 0;
 };
@@ -22,3 +22,32 @@ std::vector<Note> MelodicGenerator::generate() {
     // 4 because starting notes already used 4 bytes
     return generateMelody(std::vector<unsigned char>(seed.begin()+melodyRhythm.first + 4, seed.end()), melodyRhythm.second, melodyStartingNotes);
 }
+
+std::vector<Note> MelodicGenerator::generatePhrase(int phraseIndex, double phraseStartBeat) {
+    if (streamRhythm.empty()) {
+        // same seed layout as generate so the first phrase matches its first loop
+        const auto melodyRhythm = generateMelodyRhythm(std::vector<unsigned char>(seed.begin(), seed.end()));
+        streamRhythm = melodyRhythm.second;
+        streamStartingNotes = generateMelodyStartingNotes(std::vector<unsigned char>(seed.begin()+ melodyRhythm.first, seed.begin()+melodyRhythm.first + 5));
+        streamSeed = std::vector<unsigned char>(seed.begin()+melodyRhythm.first + 4, seed.end());
+    }
+    
+    const auto pitches = generateMelodyPitches(streamContext, streamSeed, streamSeedLocation, streamRhythm, streamStartingNotes);
+    streamSeedLocation %= streamSeed.size();
+    
+    std::vector<Note> result;
+    double location = phraseStartBeat;
+    int melodyIndex = 0;
+    for (const auto& bar : streamRhythm) {
+        for (const auto duration : bar) {
+            result.push_back(Note{pitches.at(melodyIndex++), location, duration});
+            location += duration;
+        }
+    }
+    return result;
+}
+
+void MelodicGenerator::resetStreamContext() {
+    streamContext = MelodyContext();
+    streamSeedLocation = 0;
+}
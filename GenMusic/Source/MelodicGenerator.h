@@ -25,30 +25,72 @@ public:
     MelodicGenerator(const std::vector<unsigned char> seed, const std::vector<int> roots, const std::vector<Chord> chords, bool isMajor);
     
     std::vector<Note> generate();
+    
+    // The lowest and highest notes the melody can play, worked out from the tables it picks from. Bar starts sit on
+    // LOW_C plus the root, the notes after them are picked from the root without LOW_C (so from 0) and the nearest
+    // choices to a note reach OCTAVES_EITHER_SIDE above the root.
+    static constexpr std::pair<int, int> getNoteRange() {
+        const int highest = std::max({LOW_C + HIGHEST_ROOT + widestNoteChoice(), 11 + widestNoteChoice(), HIGHEST_ROOT + widestNoteChoice() + NearestChoiceTable::OCTAVES_EITHER_SIDE * 12});
+        return {0, highest};
+    }
+    
+protected:
+    // the rhythm and starting notes stay fixed, the pitches carry on from the previous phrase's context and seed position
+    std::vector<Note> generatePhrase(int phraseIndex, double phraseStartBeat) override;
+    void resetStreamContext() override;
+    
 private:
     const std::vector<unsigned char> seed;
     const std::vector<int> roots;
     const std::vector<Chord> chords;
     bool isMajor;
     
+    // state carried between phrases of a stream
+    std::vector<std::vector<double>> streamRhythm;
+    std::vector<int> streamStartingNotes;
+    std::vector<unsigned char> streamSeed;
+    MelodyContext streamContext;
+    int streamSeedLocation = 0;
+    
     std::vector<Note> generateMelody(const std::vector<unsigned char> seedForMelody, std::vector<std::vector<double>> melodyRhythm, std::vector<int> startingNotes) {
         
         std::vector<Note> result;
         
         MelodyContext melodyContext;
+        int seedLocation = 0;
         
-        std::vector<int> melodyNoteMidiValues;
+        const auto melodyNoteMidiValues = generateMelodyPitches(melodyContext, seedForMelody, seedLocation, melodyRhythm, startingNotes);
         
-        int seedLocation = 0;
+        double location = 0.0;
+        for (int l = 0; l < LOOPS; l++) {
+            int melodyIndex = 0;
+            for (int i = 0; i < melodyRhythm.size(); i++) {
+                for (int j = 0; j < melodyRhythm[i].size(); j++) {
+                    // melodyNoteMidiValues is 1:1 with the flattened melodyRhythm
+                    auto note = melodyNoteMidiValues.at(melodyIndex++);
+                    const auto duration = melodyRhythm.at(i).at(j);
+                    result.push_back(Note{note, location, duration});
+                    location += duration;
+                }
+                
+            }
+        }
+        
+        return result;
+        
+    }
+    
+    // one pitch per note of the flattened rhythm, melodyContext and seedLocation are left where the pass finished
+    std::vector<int> generateMelodyPitches(MelodyContext& melodyContext, const std::vector<unsigned char>& seedForMelody, int& seedLocation, const std::vector<std::vector<double>>& melodyRhythm, const std::vector<int>& startingNotes) {
+        
+        std::vector<int> melodyNoteMidiValues;
         
         for (int i = 0; i<melodyRhythm.size(); i++) {
-            const auto rhythmBar = melodyRhythm.at(i);
+            const auto& rhythmBar = melodyRhythm.at(i);
             const auto rootForBar = roots.at(i);
             const auto startingNote = startingNotes.at(i);
-            const auto chordForBar = chords.at(i);
-            const auto chordForNextBar = chords.at((i+1) % BAR_COUNT);
-            const auto optionsForBar = chordForBar.getNoteChoices();
-            const auto optionsForNextBar = chordForNextBar.getNoteChoices();
+            const auto qualityForBar = chords.at(i).getQuality();
+            const auto qualityForNextBar = chords.at((i+1) % BAR_COUNT).getQuality();
             
             for (int j = 0; j<rhythmBar.size(); j++) {
                 // a note is a transition note if this note is going to hang into the next bar (the total value of what we have so far is greater than 4.0)
@@ -61,9 +103,9 @@ private:
                     const auto nextStartingNote = startingNotes.at((i+1) % BAR_COUNT);
                     const int lastNote = melodyNoteMidiValues.size() > 0 ? melodyNoteMidiValues.back() : startingNote;
                     
-                    const auto nextOptions = crossingBarLine ? optionsForNextBar : optionsForBar;
+                    const auto nextQuality = crossingBarLine ? qualityForNextBar : qualityForBar;
                     const auto currentRoot = crossingBarLine ? roots.at((i+1) % BAR_COUNT) : rootForBar;
-                    const auto nearestNotesToNextStarting = nearestNotes(nextStartingNote, currentRoot, nextOptions);
+                    const auto nearestNotesToNextStarting = nearestNotes(nextStartingNote, currentRoot, nextQuality);
                     
                     if (lastNote >= nextStartingNote) {
                         if (lastNote == nearestNotesToNextStarting.first) {
@@ -83,7 +125,7 @@ private:
                     if (j == 0) {
                         melodyNoteMidiValues.push_back(startingNote);
                     } else {
-                        melodyNoteMidiValues.push_back(getNextBestNote(melodyContext, melodyNoteMidiValues.back(), optionsForBar, seedForMelody.at(seedLocation++), rootForBar));
+                        melodyNoteMidiValues.push_back(getNextBestNote(melodyContext, melodyNoteMidiValues.back(), qualityForBar, seedForMelody.at(seedLocation++ % seedForMelody.size()), rootForBar));
                     }
                 }
                 
@@ -94,24 +136,7 @@ private:
             }
         }
         
-        
-        double location = 0.0;
-        for (int l = 0; l < LOOPS; l++) {
-            int melodyIndex = 0;
-            for (int i = 0; i < melodyRhythm.size(); i++) {
-                for (int j = 0; j < melodyRhythm[i].size(); j++) {
-                    // melodyNoteMidiValues is 1:1 with the flattened melodyRhythm
-                    auto note = melodyNoteMidiValues.at(melodyIndex++);
-                    const auto duration = melodyRhythm.at(i).at(j);
-                    result.push_back(Note{note, location, duration});
-                    location += duration;
-                }
-                
-            }
-        }
-        
-        return result;
-        
+        return melodyNoteMidiValues;
     }
     
     const std::vector<std::pair<double, int>> rhythmOptionsWeighted = {
@@ -182,7 +207,7 @@ private:
         std::vector<int> startingNotes;
         
         for (int i = 0; i < BAR_COUNT; i++) {
-            const auto noteChoices = chords[i].getNoteChoices();
+            const auto& noteChoices = chords[i].getNoteChoices();
             const auto& nextByte = seedForMelodyStartNotes[i];
             startingNotes.push_back(LOW_C + roots[i] + noteChoices[nextByte % noteChoices.size()]);
         }
@@ -190,12 +215,13 @@ private:
         return startingNotes;
     }
     
-    int getNextBestNote(MelodyContext& ctx, int lastNote, std::vector<int> noteOptions, unsigned char nextSeedValue, int root) {
+    int getNextBestNote(MelodyContext& ctx, int lastNote, ChordQuality quality, unsigned char nextSeedValue, int root) {
+        const auto& noteOptions = getNoteChoicesForQuality(quality);
         
         const int lastInterval = ctx.lastInterval;
         const int absLastInterval = std::abs(lastInterval);
         const bool isUpInterval = lastInterval > 0;
-        const auto nearestToLast = nearestNotes(lastNote, root, noteOptions);
+        const auto nearestToLast = nearestNotes(lastNote, root, quality);
         
         if (ctx.compensation > 0) {
             ctx.compensation--;
@@ -0,0 +1,169 @@
+/*
+  ==============================================================================
+
+    MixGraph.cpp
+    Created: 19 Oct 2026 10:12:44am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "MixGraph.h"
+#include <stdexcept>
+#include "DSPKernels.h"
+#include "Utilities.h"
+
+// nodes never wait on each other, only the thread calling process waits, so one pool serves every graph
+static juce::ThreadPool& getMixPool() {
+    static juce::ThreadPool pool(juce::SystemStats::getNumCpus());
+    return pool;
+}
+
+MixGraph::MixGraph(double sampleRate, int numChannels) : sampleRate(sampleRate), numChannels(numChannels) {
+
+}
+
+int MixGraph::addNode(Processor processor, AllocationStage stage) {
+    nodes.push_back({std::move(processor), stage, {}, {}, {}, {}});
+    return static_cast<int>(nodes.size()) - 1;
+}
+
+int MixGraph::addSource(juce::Synthesiser* synth, std::vector<juce::MidiMessageSequence*> sequences, double loopLengthInSamples, int loopCount, RenderedNoteCache* noteCache) {
+    return addNode([this, synth, sequences, loopLengthInSamples, loopCount, noteCache](juce::AudioBuffer<float>& buffer) {
+        AudioRenderer renderer(sampleRate, noteCache);
+        for (auto* sequence : sequences) {
+            renderer.renderLoopedMIDISequence(buffer, sequence, synth, loopLengthInSamples, loopCount);
+        }
+    });
+}
+
+int MixGraph::addBus(EffectProcessor* effect) {
+    return addNode([effect](juce::AudioBuffer<float>& buffer) {
+        if (effect != nullptr) {
+            logVerbose("Processing buffer with {} samples", buffer.getNumSamples());
+            effect->process(buffer);
+        }
+    }, AllocationStage::Effects);
+}
+
+int MixGraph::addMaster(MasterBusProcessor* master) {
+    return addNode([master](juce::AudioBuffer<float>& buffer) {
+        if (master != nullptr) {
+            master->processOffline(buffer);
+        }
+    }, AllocationStage::Effects);
+}
+
+void MixGraph::connect(int from, int to, float gain) {
+    if (from < 0 || to < 0 || from >= static_cast<int>(nodes.size()) || to >= static_cast<int>(nodes.size()) || from == to) {
+        throw std::invalid_argument("Can't connect mix graph node " + std::to_string(from) + " to " + std::to_string(to));
+    }
+    nodes[static_cast<size_t>(from)].outputs.push_back(to);
+    nodes[static_cast<size_t>(to)].inputs.push_back(from);
+    nodes[static_cast<size_t>(to)].inputGains.push_back(gain);
+}
+
+void MixGraph::prepare(int newNumSamples) {
+    // Kahn's algorithm, anything never reached is part of a cycle
+    std::vector<int> inputsLeft;
+    std::vector<int> ready;
+    for (size_t node = 0; node < nodes.size(); ++node) {
+        inputsLeft.push_back(static_cast<int>(nodes[node].inputs.size()));
+        if (inputsLeft.back() == 0) {
+            ready.push_back(static_cast<int>(node));
+        }
+    }
+    size_t reached = 0;
+    while (!ready.empty()) {
+        const auto node = ready.back();
+        ready.pop_back();
+        reached++;
+        for (auto output : nodes[static_cast<size_t>(node)].outputs) {
+            if (--inputsLeft[static_cast<size_t>(output)] == 0) {
+                ready.push_back(output);
+            }
+        }
+    }
+    if (reached != nodes.size()) {
+        throw std::invalid_argument("The mix graph has a cycle");
+    }
+
+    numSamples = newNumSamples;
+    for (auto& node : nodes) {
+        node.buffer = AudioBufferPool::get().acquire(numChannels, numSamples);
+    }
+    waitingOn = std::make_unique<std::atomic<int>[]>(nodes.size());
+}
+
+void MixGraph::process() {
+    if (waitingOn == nullptr) {
+        throw std::logic_error("MixGraph::prepare has to be called before process");
+    }
+    if (nodes.empty()) {
+        return;
+    }
+
+    failure = nullptr;
+    finished.reset();
+    remaining = static_cast<int>(nodes.size());
+    for (size_t node = 0; node < nodes.size(); ++node) {
+        waitingOn[node] = static_cast<int>(nodes[node].inputs.size());
+    }
+    for (size_t node = 0; node < nodes.size(); ++node) {
+        if (nodes[node].inputs.empty()) {
+            schedule(static_cast<int>(node));
+        }
+    }
+    finished.wait();
+
+    if (failure != nullptr) {
+        std::rethrow_exception(failure);
+    }
+}
+
+void MixGraph::schedule(int node) {
+    getMixPool().addJob([this, node]() {
+        runNode(node);
+        return juce::ThreadPoolJob::jobHasFinished;
+    });
+}
+
+void MixGraph::runNode(int index) {
+    auto& node = nodes[static_cast<size_t>(index)];
+
+    try {
+        AllocationTracker::StageScope stage(node.stage);
+        node.buffer->clear();
+        const auto& kernels = DSPKernels::get();
+        for (size_t input = 0; input < node.inputs.size(); ++input) {
+            const auto& inputBuffer = *nodes[static_cast<size_t>(node.inputs[input])].buffer;
+            for (int channel = 0; channel < numChannels; ++channel) {
+                kernels.addScaled(node.buffer->getWritePointer(channel), inputBuffer.getReadPointer(channel), node.inputGains[input], numSamples);
+            }
+        }
+        node.processor(*node.buffer);
+    } catch (...) {
+        // the rest of the graph still runs so process has something to wait for, the first failure is rethrown there
+        std::lock_guard<std::mutex> lock(failureLock);
+        if (failure == nullptr) {
+            failure = std::current_exception();
+        }
+    }
+
+    for (auto output : node.outputs) {
+        if (--waitingOn[static_cast<size_t>(output)] == 0) {
+            schedule(output);
+        }
+    }
+    if (--remaining == 0) {
+        finished.signal();
+    }
+}
+
+juce::AudioBuffer<float>& MixGraph::getOutput(int node) {
+    auto& buffer = nodes.at(static_cast<size_t>(node)).buffer;
+    if (buffer.get() == nullptr) {
+        throw std::logic_error("MixGraph::prepare has to be called before getOutput");
+    }
+    return *buffer;
+}
@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    MixGraph.h
+    Created: 19 Oct 2026 10:12:44am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "AudioRenderer.h"
+#include "EffectProcessor.h"
+#include "MasterBusProcessor.h"
+#include "AllocationTracker.h"
+#include "AudioBufferPool.h"
+
+/*
+    Offline routing as a graph: synth sources feed busses, busses can feed group busses and everything ends up at a
+    master. Edges are explicit, so any shape of sub-mix works.
+
+    process runs every node on a thread pool as soon as all of its inputs are done, so independent sources and busses
+    render on different cores. Every node's buffer comes from the AudioBufferPool in prepare and holds that node's
+    whole output, a node starts by summing its inputs' buffers into its own. They go back to the pool with the graph,
+    so the next song's graph finds them there.
+ */
+class MixGraph {
+public:
+    // the buffer arrives holding the sum of the node's inputs, silence for a node without any, and is worked on in place
+    using Processor = std::function<void(juce::AudioBuffer<float>&)>;
+
+    MixGraph(double sampleRate, int numChannels = 2);
+
+    // the synth plays every sequence, loop aware like AudioRenderer::renderLoopedMIDISequence. Nodes run at the same
+    // time as each other, so a synth can only be behind one source. Sources can share a noteCache
+    int addSource(juce::Synthesiser* synth, std::vector<juce::MidiMessageSequence*> sequences, double loopLengthInSamples = 0.0, int loopCount = 1, RenderedNoteCache* noteCache = nullptr);
+    // effect can be nullptr for a plain sum, a bus fed by other busses is a group bus
+    int addBus(EffectProcessor* effect);
+    // master can be nullptr to pass the mix through untouched
+    int addMaster(MasterBusProcessor* master);
+    // anything else, like a stem that has already been rendered
+    int addNode(Processor processor, AllocationStage stage = AllocationStage::Render);
+    // gain is what from is scaled by on its way into to, a send level for an edge into an aux return
+    void connect(int from, int to, float gain = 1.0f);
+
+    // sizes every node's buffer, throws if the edges make a cycle
+    void prepare(int numSamples);
+    void process();
+
+    juce::AudioBuffer<float>& getOutput(int node);
+
+private:
+    struct Node {
+        Processor processor;
+        AllocationStage stage;
+        std::vector<int> inputs;
+        std::vector<float> inputGains;
+        std::vector<int> outputs;
+        PooledAudioBuffer buffer;
+    };
+
+    double sampleRate;
+    int numChannels;
+    int numSamples = 0;
+    std::vector<Node> nodes;
+
+    // per run, how many inputs each node is still waiting for
+    std::unique_ptr<std::atomic<int>[]> waitingOn;
+    std::atomic<int> remaining { 0 };
+    juce::WaitableEvent finished;
+    std::mutex failureLock;
+    std::exception_ptr failure;
+
+    void schedule(int node);
+    void runNode(int node);
+};
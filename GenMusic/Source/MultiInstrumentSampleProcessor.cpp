@@ -9,39 +9,87 @@
 */
 
 #include "MultiInstrumentSampleProcessor.h"
+#include "SampleLoader.h"
+#include "Utilities.h"
 
 
-MultiInstrumentSampleProcessor::MultiInstrumentSampleProcessor(std::map<int, std::string> filePaths) {
+MultiInstrumentSampleProcessor::MultiInstrumentSampleProcessor(std::map<int, std::string> filePaths, double sampleRate, bool compactStorage) {
     
     // iterate through the midi note, file path map and process them into the audio buffers
     
     for (auto const& [midiNote, filePath] : filePaths) {
-        juce::File file(filePath);
-        juce::AudioFormatManager formatManager;
-        formatManager.registerBasicFormats();
-        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
-        
-        if (reader.get() != nullptr) {
-            juce::AudioBuffer<float> audioSampleBuffer((int)reader->numChannels, (int)reader->lengthInSamples);
-            reader->read(&audioSampleBuffer, 0, (int)reader->lengthInSamples, 0, true, true);
-            audioSampleBuffers[midiNote] = audioSampleBuffer;
-        }
+        audioSampleBuffers[midiNote] = std::make_shared<const juce::AudioBuffer<float>>(SampleLoader::load(filePath, sampleRate));
+        hashCombine(identity, midiNote);
+        hashCombine(identity, SampleLoader::getSampleIdentity(filePath, {}));
+    }
+    hashCombine(identity, sampleRate);
+    
+    if (compactStorage) {
+        compactSamples();
+    }
+}
+
+MultiInstrumentSampleProcessor::MultiInstrumentSampleProcessor(std::map<int, juce::AudioBuffer<float>> buffers, std::size_t sampleIdentity, bool compactStorage) : identity(sampleIdentity) {
+    for (auto& [midiNote, buffer] : buffers) {
+        audioSampleBuffers[midiNote] = std::make_shared<const juce::AudioBuffer<float>>(std::move(buffer));
+        hashCombine(identity, midiNote);
+    }
+    
+    if (compactStorage) {
+        compactSamples();
+    }
+}
+
+void MultiInstrumentSampleProcessor::compactSamples() {
+    for (auto const& [midiNote, buffer] : audioSampleBuffers) {
+        compactSampleBuffers[midiNote] = std::make_shared<const CompactAudioBuffer>(*buffer);
+    }
+    audioSampleBuffers.clear();
+    hashCombine(identity, true);
+}
+
+std::shared_ptr<const CompactAudioBuffer> MultiInstrumentSampleProcessor::getCompactAudioForNoteNumber(int noteNumber) {
+    if (compactSampleBuffers.empty()) {
+        return nullptr;
     }
     
+    auto it = compactSampleBuffers.find(noteNumber);
+    if (it != compactSampleBuffers.end()) {
+        return it->second;
+    }
+    
+    throw std::runtime_error("Note not found");
 }
 
 
 
+std::shared_ptr<const juce::AudioBuffer<float>> MultiInstrumentSampleProcessor::getSharedAudioForNoteNumber(int noteNumber) {
+    if (!compactSampleBuffers.empty()) {
+        return nullptr;
+    }
+    
+    auto it = audioSampleBuffers.find(noteNumber);
+    if (it != audioSampleBuffers.end()) {
+        return it->second;
+    }
+    
+    throw std::runtime_error("Note not found");
+}
+
 // TODO return copy of audio buffer
 juce::AudioBuffer<float> MultiInstrumentSampleProcessor::getAudioForNoteNumber(int noteNumber) {
     
     // check if the note exists in the map
+    if (!compactSampleBuffers.empty()) {
+        return getCompactAudioForNoteNumber(noteNumber)->toFloat();
+    }
+    
     auto it = audioSampleBuffers.find(noteNumber);
 
     if (it != audioSampleBuffers.end()) {
         // copy buffer
         juce::AudioBuffer<float> copyOfBuffer;
-        copyOfBuffer.makeCopyOf(it->second);
+        copyOfBuffer.makeCopyOf(*it->second);
         
         return copyOfBuffer;
     }
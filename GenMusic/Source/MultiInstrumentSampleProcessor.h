@@ -16,10 +16,21 @@
 class MultiInstrumentSampleProcessor : public SampleProcessor {
 public:
     
-    MultiInstrumentSampleProcessor(std::map<int, std::string> filePaths);
+    // compactStorage keeps the samples as 16 bit instead of float
+    MultiInstrumentSampleProcessor(std::map<int, std::string> filePaths, double sampleRate, bool compactStorage = false);
+    // buffers are already at the render sample rate, sampleIdentity changes whenever their audio does
+    MultiInstrumentSampleProcessor(std::map<int, juce::AudioBuffer<float>> buffers, std::size_t sampleIdentity, bool compactStorage = false);
     juce::AudioBuffer<float> getAudioForNoteNumber(int noteNumber) override;
+    std::shared_ptr<const CompactAudioBuffer> getCompactAudioForNoteNumber(int noteNumber) override;
+    std::shared_ptr<const juce::AudioBuffer<float>> getSharedAudioForNoteNumber(int noteNumber) override;
+    std::size_t getIdentityHash() const override { return identity; }
     
 private:
-    // sample buffers
-    std::map<int, juce::AudioBuffer<float>> audioSampleBuffers;
+    // sample buffers, shared with the voices playing them
+    std::map<int, std::shared_ptr<const juce::AudioBuffer<float>>> audioSampleBuffers;
+    // takes the place of audioSampleBuffers with compact storage
+    std::map<int, std::shared_ptr<const CompactAudioBuffer>> compactSampleBuffers;
+    std::size_t identity = 0;
+
+    void compactSamples();
 };
@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    MultiZoneSampleProcessor.cpp
+    Created: 19 Oct 2026 9:37:28am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "MultiZoneSampleProcessor.h"
+#include "Utilities.h"
+
+
+MultiZoneSampleProcessor::MultiZoneSampleProcessor(std::map<int, std::string> filePaths, const RenderSettings& settings) {
+    if (filePaths.empty()) {
+        throw std::invalid_argument("MultiZoneSampleProcessor needs at least one zone");
+    }
+
+    for (auto const& [rootMidiNote, filePath] : filePaths) {
+        zones[rootMidiNote] = std::make_unique<RepitchingSingleInstrumentSampleProcessor>(filePath, rootMidiNote, settings);
+    }
+}
+
+MultiZoneSampleProcessor::MultiZoneSampleProcessor(std::map<int, std::string> filePaths, const RenderSettings& settings, std::vector<Note> notes) : MultiZoneSampleProcessor(filePaths, settings) {
+    for (auto note : notes) {
+        getAudioForNoteNumber(note.midiNoteNumber);
+    }
+}
+
+MultiZoneSampleProcessor::MultiZoneSampleProcessor(std::map<int, std::unique_ptr<RepitchingSingleInstrumentSampleProcessor>> zones) : zones(std::move(zones)) {
+    if (this->zones.empty()) {
+        throw std::invalid_argument("MultiZoneSampleProcessor needs at least one zone");
+    }
+}
+
+juce::AudioBuffer<float> MultiZoneSampleProcessor::getAudioForNoteNumber(int noteNumber) {
+    return getNearestZone(noteNumber).getAudioForNoteNumber(noteNumber);
+}
+
+std::shared_ptr<const CompactAudioBuffer> MultiZoneSampleProcessor::getCompactAudioForNoteNumber(int noteNumber) {
+    return getNearestZone(noteNumber).getCompactAudioForNoteNumber(noteNumber);
+}
+
+std::shared_ptr<const juce::AudioBuffer<float>> MultiZoneSampleProcessor::getSharedAudioForNoteNumber(int noteNumber) {
+    return getNearestZone(noteNumber).getSharedAudioForNoteNumber(noteNumber);
+}
+
+RepitchCacheStats MultiZoneSampleProcessor::getCacheStats() const {
+    RepitchCacheStats stats;
+    for (const auto& zone : zones) {
+        stats += zone.second->getCacheStats();
+    }
+    return stats;
+}
+
+std::size_t MultiZoneSampleProcessor::getIdentityHash() const {
+    std::size_t hash = 0;
+    for (const auto& zone : zones) {
+        hashCombine(hash, zone.second->getIdentityHash());
+    }
+    return hash;
+}
+
+RepitchingSingleInstrumentSampleProcessor& MultiZoneSampleProcessor::getNearestZone(int noteNumber) {
+    // first zone rooted at or above the note, compare it with the one below and take the closer of the two
+    auto above = zones.lower_bound(noteNumber);
+    if (above == zones.end()) {
+        return *std::prev(above)->second;
+    }
+    if (above == zones.begin()) {
+        return *above->second;
+    }
+
+    auto below = std::prev(above);
+    // on a tie pitch the upper recording down, it holds up better than stretching one upwards
+    if (noteNumber - below->first < above->first - noteNumber) {
+        return *below->second;
+    }
+    return *above->second;
+}
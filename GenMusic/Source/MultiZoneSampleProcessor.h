@@ -0,0 +1,40 @@
+/*
+  ==============================================================================
+
+    MultiZoneSampleProcessor.h
+    Created: 19 Oct 2026 9:37:28am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Note.h"
+#include "SampleProcessor.h"
+#include "RepitchingSingleInstrumentSampleProcessor.h"
+
+// one instrument recorded at several pitches, each note is repitched from the recording with the nearest root
+class MultiZoneSampleProcessor : public SampleProcessor {
+public:
+
+    // filePaths maps the root midi note of each recording to its file
+    MultiZoneSampleProcessor(std::map<int, std::string> filePaths, const RenderSettings& settings);
+    MultiZoneSampleProcessor(std::map<int, std::string> filePaths, const RenderSettings& settings, std::vector<Note> notes);
+    // zones that have already been loaded, keyed by their root midi note
+    explicit MultiZoneSampleProcessor(std::map<int, std::unique_ptr<RepitchingSingleInstrumentSampleProcessor>> zones);
+
+    juce::AudioBuffer<float> getAudioForNoteNumber(int noteNumber) override;
+    std::shared_ptr<const CompactAudioBuffer> getCompactAudioForNoteNumber(int noteNumber) override;
+    std::shared_ptr<const juce::AudioBuffer<float>> getSharedAudioForNoteNumber(int noteNumber) override;
+    std::size_t getIdentityHash() const override;
+    // every zone's cache added together
+    RepitchCacheStats getCacheStats() const;
+
+private:
+    RepitchingSingleInstrumentSampleProcessor& getNearestZone(int noteNumber);
+
+    // the zones keyed by their root midi note
+    std::map<int, std::unique_ptr<RepitchingSingleInstrumentSampleProcessor>> zones;
+};
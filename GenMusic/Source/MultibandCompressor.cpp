@@ -0,0 +1,204 @@
+/*
+  ==============================================================================
+
+    MultibandCompressor.cpp
+    Created: 19 Oct 2026 10:11:11am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "MultibandCompressor.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include "Utilities.h"
+
+// Shared by every compressor. MixGraph runs busses at the same time, so several compressors can have bands queued
+// here at once and they just share the cores. It has to stay its own pool rather than the mix pool: process runs on a
+// mix pool thread and blocks until its bands are done, if the bands queued behind busses doing the same on that pool
+// every thread could end up waiting on jobs none of them is free to run
+static juce::ThreadPool& getBandPool() {
+    static juce::ThreadPool pool(juce::SystemStats::getNumCpus());
+    return pool;
+}
+
+static float coefficientForTime(double sampleRate, float milliseconds) {
+    return static_cast<float>(std::exp(-1.0 / (sampleRate * milliseconds * 0.001)));
+}
+
+MultibandCompressor::MultibandCompressor(double sampleRate, std::vector<float> crossoverFrequencies, std::vector<CompressorBand> bandSettings) {
+    if (bandSettings.size() != crossoverFrequencies.size() + 1) {
+        throw std::invalid_argument("A multiband compressor needs one more band than it has crossovers");
+    }
+    if (!std::is_sorted(crossoverFrequencies.begin(), crossoverFrequencies.end())) {
+        throw std::invalid_argument("Crossovers have to go from lowest to highest");
+    }
+    for (const auto& settings : bandSettings) {
+        if (settings.ratio < 1.0f) {
+            throw std::invalid_argument("A compressor band's ratio can't be below 1");
+        }
+    }
+
+    juce::dsp::ProcessSpec spec;
+    spec.sampleRate = sampleRate;
+    spec.maximumBlockSize = PREALLOCATED_SAMPLES;
+    spec.numChannels = CHANNELS;
+
+    for (auto frequency : crossoverFrequencies) {
+        crossovers.emplace_back();
+        crossovers.back().setCutoffFrequency(frequency);
+        crossovers.back().prepare(spec);
+    }
+
+    for (size_t band = 0; band < bandSettings.size(); ++band) {
+        allpasses.emplace_back();
+        for (size_t above = band + 1; above < crossoverFrequencies.size(); ++above) {
+            allpasses.back().emplace_back();
+            auto& allpass = allpasses.back().back();
+            allpass.setType(juce::dsp::LinkwitzRileyFilterType::allpass);
+            allpass.setCutoffFrequency(crossoverFrequencies[above]);
+            allpass.prepare(spec);
+        }
+
+        BandState state;
+        state.settings = bandSettings[band];
+        state.attackCoefficient = coefficientForTime(sampleRate, bandSettings[band].attackMs);
+        state.releaseCoefficient = coefficientForTime(sampleRate, bandSettings[band].releaseMs);
+        state.makeupGain = juce::Decibels::decibelsToGain(bandSettings[band].makeupDb);
+        state.audio.setSize(CHANNELS, PREALLOCATED_SAMPLES);
+        state.gains.resize(PREALLOCATED_SAMPLES);
+        bands.push_back(std::move(state));
+    }
+    bandSamples.resize(bands.size());
+
+    configurationHash = typeid(MultibandCompressor).hash_code();
+    hashCombine(configurationHash, sampleRate);
+    for (auto frequency : crossoverFrequencies) {
+        hashCombine(configurationHash, frequency);
+    }
+    for (const auto& settings : bandSettings) {
+        for (auto value : {settings.thresholdDb, settings.ratio, settings.attackMs, settings.releaseMs, settings.makeupDb}) {
+            hashCombine(configurationHash, value);
+        }
+    }
+}
+
+void MultibandCompressor::reset() {
+    for (auto& crossover : crossovers) {
+        crossover.reset();
+    }
+    for (auto& bandAllpasses : allpasses) {
+        for (auto& allpass : bandAllpasses) {
+            allpass.reset();
+        }
+    }
+    for (auto& band : bands) {
+        band.envelope = 0.0f;
+    }
+}
+
+void MultibandCompressor::process(juce::AudioBuffer<float>& buffer) {
+    const int numChannels = std::min(CHANNELS, buffer.getNumChannels());
+    const int numSamples = buffer.getNumSamples();
+
+    for (auto& band : bands) {
+        band.audio.setSize(CHANNELS, numSamples, false, false, true);
+        if (band.gains.size() < static_cast<size_t>(numSamples)) {
+            band.gains.resize(static_cast<size_t>(numSamples));
+        }
+    }
+
+    split(buffer, numChannels, numSamples);
+
+    if (numSamples >= PARALLEL_THRESHOLD && bands.size() > 1) {
+        std::atomic<int> remaining { static_cast<int>(bands.size()) - 1 };
+        juce::WaitableEvent finished;
+        for (size_t band = 1; band < bands.size(); ++band) {
+            getBandPool().addJob([this, band, numChannels, numSamples, &remaining, &finished]() {
+                compressBand(bands[band], numChannels, numSamples);
+                if (--remaining == 0) {
+                    finished.signal();
+                }
+                return juce::ThreadPoolJob::jobHasFinished;
+            });
+        }
+        compressBand(bands[0], numChannels, numSamples);
+        finished.wait();
+    } else {
+        for (auto& band : bands) {
+            compressBand(band, numChannels, numSamples);
+        }
+    }
+
+    for (int channel = 0; channel < numChannels; ++channel) {
+        auto* output = buffer.getWritePointer(channel);
+        juce::FloatVectorOperations::copy(output, bands[0].audio.getReadPointer(channel), numSamples);
+        for (size_t band = 1; band < bands.size(); ++band) {
+            juce::FloatVectorOperations::add(output, bands[band].audio.getReadPointer(channel), numSamples);
+        }
+    }
+
+    logVerbose("Processed MultibandCompressor");
+}
+
+void MultibandCompressor::split(const juce::AudioBuffer<float>& buffer, int numChannels, int numSamples) {
+    for (int channel = 0; channel < numChannels; ++channel) {
+        for (size_t band = 0; band < bands.size(); ++band) {
+            bandSamples[band] = bands[band].audio.getWritePointer(channel);
+        }
+
+        // each crossover takes what was above the last one, the filters carry state so this has to go a sample at a time
+        const auto* input = buffer.getReadPointer(channel);
+        for (int i = 0; i < numSamples; ++i) {
+            float rest = input[i];
+            for (size_t crossover = 0; crossover < crossovers.size(); ++crossover) {
+                float low, high;
+                crossovers[crossover].processSample(channel, rest, low, high);
+                bandSamples[crossover][i] = low;
+                rest = high;
+            }
+            bandSamples.back()[i] = rest;
+        }
+
+        for (size_t band = 0; band < bands.size(); ++band) {
+            for (auto& allpass : allpasses[band]) {
+                for (int i = 0; i < numSamples; ++i) {
+                    bandSamples[band][i] = allpass.processSample(channel, bandSamples[band][i]);
+                }
+            }
+        }
+    }
+
+    for (auto& crossover : crossovers) {
+        crossover.snapToZero();
+    }
+    for (auto& bandAllpasses : allpasses) {
+        for (auto& allpass : bandAllpasses) {
+            allpass.snapToZero();
+        }
+    }
+}
+
+void MultibandCompressor::compressBand(BandState& band, int numChannels, int numSamples) {
+    const auto& settings = band.settings;
+    const float slope = 1.0f - 1.0f / settings.ratio;
+
+    for (int i = 0; i < numSamples; ++i) {
+        float level = 0.0f;
+        for (int channel = 0; channel < numChannels; ++channel) {
+            level = std::max(level, std::abs(band.audio.getReadPointer(channel)[i]));
+        }
+
+        const float coefficient = level > band.envelope ? band.attackCoefficient : band.releaseCoefficient;
+        band.envelope = level + (band.envelope - level) * coefficient;
+
+        const float overshootDb = juce::Decibels::gainToDecibels(band.envelope) - settings.thresholdDb;
+        band.gains[i] = overshootDb > 0.0f ? juce::Decibels::decibelsToGain(-overshootDb * slope) * band.makeupGain : band.makeupGain;
+    }
+
+    for (int channel = 0; channel < numChannels; ++channel) {
+        juce::FloatVectorOperations::multiply(band.audio.getWritePointer(channel), band.gains.data(), numSamples);
+    }
+}
@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    MultibandCompressor.h
+    Created: 19 Oct 2026 10:11:11am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <vector>
+#include "EffectProcessor.h"
+
+struct CompressorBand {
+    float thresholdDb;
+    float ratio;
+    float attackMs;
+    float releaseMs;
+    float makeupDb;
+};
+
+/*
+    Splits the signal with Linkwitz-Riley crossovers, compresses each band on its own and sums them back together.
+    The lower bands go through allpasses at the crossovers above theirs, so with no compression the sum comes back
+    flat.
+
+    Detection and gain for each band only read that band, so on long offline buffers every band after the first is
+    handed to a worker while the calling thread does the first. Short buffers, like a device block, stay on the
+    calling thread and don't allocate.
+ */
+class MultibandCompressor : public EffectProcessor {
+public:
+    // crossovers in Hz from lowest to highest, there has to be one more band than there are crossovers
+    MultibandCompressor(double sampleRate, std::vector<float> crossoverFrequencies, std::vector<CompressorBand> bands);
+
+    void process(juce::AudioBuffer<float>& buffer) override;
+    void reset() override;
+    std::size_t getConfigurationHash() const override { return configurationHash; }
+
+private:
+    static constexpr int CHANNELS = 2;
+    // buffers at least this long get a worker per band, anything shorter isn't worth the hand off
+    static constexpr int PARALLEL_THRESHOLD = 1 << 15;
+    // enough for any device block, so live playback never resizes
+    static constexpr int PREALLOCATED_SAMPLES = 4096;
+
+    struct BandState {
+        CompressorBand settings;
+        float attackCoefficient;
+        float releaseCoefficient;
+        float makeupGain;
+        // linked across the channels
+        float envelope = 0.0f;
+        juce::AudioBuffer<float> audio;
+        std::vector<float> gains;
+    };
+
+    std::vector<juce::dsp::LinkwitzRileyFilter<float>> crossovers;
+    // allpasses[band] are the crossovers above the one the band came out of
+    std::vector<std::vector<juce::dsp::LinkwitzRileyFilter<float>>> allpasses;
+    std::vector<BandState> bands;
+    std::vector<float*> bandSamples;
+    std::size_t configurationHash = 0;
+
+    void split(const juce::AudioBuffer<float>& buffer, int numChannels, int numSamples);
+    static void compressBand(BandState& band, int numChannels, int numSamples);
+};
@@ -10,51 +10,96 @@
 
 #pragma once
 #include "Note.h"
+#include "Chord.h"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <vector>
 
 
 class NoteGenerator {
 public:
     static const int BAR_COUNT = 4;
     static const int LOOPS = 2;
+    static const int BEATS_PER_BAR = 4.0;
     
-    virtual ~NoteGenerator() = default;
-    virtual std::vector<Note> generate() = 0;
+    static const int LOW_C = 24;
     
-protected:
+    static constexpr std::array<int, 8> majorScaleIntervals = {0, 2, 4, 5, 7, 9, 11, 12};
+    static constexpr std::array<int, 8> minorScaleIntervals = {0, 2, 3, 3, 5, 5, 7, 10};
     
-    static const int BEATS_PER_BAR = 4.0;
-    static const int LOW_C = 24;
+    // every root is the key, 0 to 11, plus a step of the scale (they're listed in order)
+    static constexpr int HIGHEST_ROOT = 11 + std::max(majorScaleIntervals.back(), minorScaleIntervals.back());
     
-    const std::vector<int> majorScaleIntervals = {0, 2, 4, 5, 7, 9, 11, 12};
-    const std::vector<int> minorScaleIntervals = {0, 2, 3, 3, 5, 5, 7, 10};
-
+    // the furthest above its root any quality's note choices reach
+    static constexpr int widestNoteChoice() {
+        int widest = 0;
+        for (const auto& choices : noteChoicesForQuality) {
+            for (int interval : choices.intervals) {
+                widest = std::max(widest, interval);
+            }
+        }
+        return widest;
+    }
+    
+    static constexpr double PHRASE_LENGTH_IN_BEATS = BAR_COUNT * BEATS_PER_BAR;
+    
+    virtual ~NoteGenerator() = default;
+    virtual std::vector<Note> generate() = 0;
     
-    std::pair<int, int> nearestNotes(int note, int root, const std::vector<int>& noteChoices) {
-        int nearestBelow = -1;
-        int nearestAbove = 1000; // Set to a high number beyond the MIDI note range
+    // Streaming: the notes starting in [startBeat, startBeat + lengthInBeats). Windows have to be asked for in order,
+    // the generator carries its context from one phrase to the next so the stream can run for as long as needed while
+    // only ever holding on to one phrase of notes.
+    std::vector<Note> generateWindow(double startBeat, double lengthInBeats) {
+        if (startBeat < streamPosition) {
+            throw std::invalid_argument("stream windows have to be requested in order");
+        }
         
-        // sortedCopy is a copy of noteChoices sorted in ascending order
-        std::vector<int> sortedCopy = noteChoices;
-        std::sort(sortedCopy.begin(), sortedCopy.end());
-
-        for (int interval : sortedCopy) {
-            int midiNote = root + interval;
-
-            // Loop through octaves to check for nearest notes
-            for (int octave = -2; octave <= 2; ++octave) {
-                int currentNote = midiNote + octave * 12;
-                if (currentNote < note && currentNote > nearestBelow) {
-                    nearestBelow = currentNote;
-                }
-                if (currentNote > note && currentNote < nearestAbove) {
-                    nearestAbove = currentNote;
-                }
+        const double endBeat = startBeat + lengthInBeats;
+        while (nextPhraseStart < endBeat) {
+            for (const auto& note : generatePhrase(nextPhraseIndex, nextPhraseStart)) {
+                pendingNotes.push_back(note);
             }
+            nextPhraseIndex++;
+            nextPhraseStart += PHRASE_LENGTH_IN_BEATS;
         }
+        
+        std::vector<Note> window;
+        std::vector<Note> remaining;
+        for (const auto& note : pendingNotes) {
+            if (note.startTimeInBeats >= endBeat) {
+                remaining.push_back(note);
+            } else if (note.startTimeInBeats >= startBeat) {
+                window.push_back(note);
+            }
+        }
+        pendingNotes = std::move(remaining);
+        streamPosition = endBeat;
+        
+        return window;
+    }
+    
+    void resetStream() {
+        pendingNotes.clear();
+        nextPhraseIndex = 0;
+        nextPhraseStart = 0.0;
+        streamPosition = 0.0;
+        resetStreamContext();
+    }
+    
+protected:
+    // the notes for one PHRASE_LENGTH_IN_BEATS long phrase of the stream, the first phrase matches the first loop of generate()
+    virtual std::vector<Note> generatePhrase(int phraseIndex, double phraseStartBeat) = 0;
+    virtual void resetStreamContext() {}
 
-        // Edge case: if no notes are found above or below
-        if (nearestBelow == -1) nearestBelow = note; // Default to the note itself
-        if (nearestAbove == 1000) nearestAbove = note; // Default to the note itself
-        return {nearestBelow, nearestAbove};
+    
+    std::pair<int, int> nearestNotes(int note, int root, ChordQuality quality) {
+        return nearestChoices(note, root, quality);
     }
+    
+private:
+    std::vector<Note> pendingNotes;
+    int nextPhraseIndex = 0;
+    double nextPhraseStart = 0.0;
+    double streamPosition = 0.0;
 };
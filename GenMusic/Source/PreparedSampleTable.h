@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    PreparedSampleTable.h
+    Created: 19 Oct 2026 9:53:11am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "SampleProcessor.h"
+
+// one note's audio, compact when the processor stores it that way and float otherwise
+struct PreparedNote {
+    juce::AudioBuffer<float> audio;
+    std::shared_ptr<const CompactAudioBuffer> compact;
+};
+
+/*
+    Per-note sample audio the audio thread can look up without locking, allocating or repitching. The control thread
+    fills it in with prepare, which may decode or repitch, and a note only becomes visible once its audio is complete.
+    Nothing is ever removed, so a pointer handed out stays valid for the life of the table.
+ */
+class PreparedSampleTable {
+public:
+    PreparedSampleTable(std::shared_ptr<SampleProcessor> processor) : processor(processor) {
+        for (auto& slot : slots) {
+            slot.store(nullptr);
+        }
+    }
+    
+    // control thread only
+    void prepare(int noteNumber) {
+        if (noteNumber < 0 || noteNumber >= NOTE_COUNT || slots[noteNumber].load(std::memory_order_acquire) != nullptr) {
+            return;
+        }
+        auto note = std::make_unique<PreparedNote>();
+        note->compact = processor->getCompactAudioForNoteNumber(noteNumber);
+        if (note->compact == nullptr) {
+            note->audio = processor->getAudioForNoteNumber(noteNumber);
+        }
+        slots[noteNumber].store(note.get(), std::memory_order_release);
+        preparedAudio.push_back(std::move(note));
+    }
+    
+    // safe to call from the audio thread, nullptr if the note was never prepared
+    const PreparedNote* find(int noteNumber) const {
+        if (noteNumber < 0 || noteNumber >= NOTE_COUNT) {
+            return nullptr;
+        }
+        return slots[noteNumber].load(std::memory_order_acquire);
+    }
+    
+private:
+    static constexpr int NOTE_COUNT = 128;
+    
+    std::shared_ptr<SampleProcessor> processor;
+    std::array<std::atomic<const PreparedNote*>, NOTE_COUNT> slots;
+    std::vector<std::unique_ptr<PreparedNote>> preparedAudio;
+};
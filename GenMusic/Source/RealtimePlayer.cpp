@@ -0,0 +1,207 @@
+/*
+  ==============================================================================
+
+    RealtimePlayer.cpp
+    Created: 19 Oct 2026 9:53:11am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "RealtimePlayer.h"
+#include <algorithm>
+#include "AllocationTracker.h"
+#include "DSPKernels.h"
+#include "Utilities.h"
+
+RealtimePlayer::RealtimePlayer(double sampleRate) : sampleRate(sampleRate), queue(QUEUE_SIZE), callbackMs(TIMING_HISTORY, 0.0f) {
+    pending.reserve(QUEUE_SIZE);
+}
+
+int RealtimePlayer::getBusIndex(int bus) {
+    for (size_t i = 0; i < busses.size(); ++i) {
+        if (busses[i].identifier == bus) {
+            return static_cast<int>(i);
+        }
+    }
+    busses.push_back({bus, nullptr, 0.0f, {}});
+    return static_cast<int>(busses.size()) - 1;
+}
+
+int RealtimePlayer::addSynth(juce::Synthesiser* synth, int bus) {
+    synths.push_back({synth, getBusIndex(bus), {}});
+    return static_cast<int>(synths.size()) - 1;
+}
+
+void RealtimePlayer::setBusEffect(int bus, EffectProcessor* effect) {
+    busses[getBusIndex(bus)].effect = effect;
+}
+
+void RealtimePlayer::setBusSend(int bus, float level) {
+    busses[getBusIndex(bus)].send = level;
+}
+
+void RealtimePlayer::setAuxReturn(EffectProcessor* effect) {
+    auxReturn = effect;
+}
+
+void RealtimePlayer::setMasterBus(MasterBusProcessor* master) {
+    masterBus = master;
+}
+
+void RealtimePlayer::prepare(int newMaximumBlockSize) {
+    maximumBlockSize = newMaximumBlockSize;
+    mix.setSize(2, maximumBlockSize);
+    returnBuffer.setSize(2, maximumBlockSize);
+    for (auto& bus : busses) {
+        bus.buffer.setSize(2, maximumBlockSize);
+    }
+    for (auto& slot : synths) {
+        slot.midi.ensureSize(MIDI_BUFFER_BYTES);
+        slot.synth->setCurrentPlaybackSampleRate(sampleRate);
+    }
+}
+
+bool RealtimePlayer::schedule(int synthIndex, juce::int64 position, int noteNumber, float velocity, bool isNoteOn) {
+    if (fifo.getFreeSpace() < 1) {
+        return false;
+    }
+    const auto write = fifo.write(1);
+    write.forEach([&](int index) {
+        queue[static_cast<size_t>(index)] = {position, synthIndex, noteNumber, velocity, isNoteOn};
+    });
+    return true;
+}
+
+void RealtimePlayer::audioDeviceIOCallbackWithContext(const float* const*, int, float* const* outputChannelData, int numOutputChannels, int numSamples, const juce::AudioIODeviceCallbackContext&) {
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    // whichever thread the device calls back on can't print
+    loggingMuted = true;
+    
+    renderBlock(outputChannelData, numOutputChannels, numSamples);
+    
+    const auto elapsedMs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+    const auto index = callbackCount.load(std::memory_order_relaxed);
+    callbackMs[static_cast<size_t>(index % TIMING_HISTORY)] = static_cast<float>(elapsedMs);
+    callbackCount.store(index + 1, std::memory_order_release);
+    if (elapsedMs > numSamples * 1000.0 / sampleRate) {
+        xruns++;
+    }
+}
+
+void RealtimePlayer::renderBlock(float* const* outputChannelData, int numOutputChannels, int numSamples) {
+    AllocationTracker::StageScope stage(AllocationStage::Render);
+    // take everything the control thread has queued, the note offs are usually far ahead of the note ons around them
+    const auto read = fifo.read(fifo.getNumReady());
+    read.forEach([&](int index) {
+        if (pending.size() < pending.capacity()) {
+            pending.push_back(queue[static_cast<size_t>(index)]);
+        } else {
+            droppedEvents++;
+        }
+    });
+    
+    for (int blockStart = 0; blockStart < numSamples; blockStart += maximumBlockSize) {
+        const int blockSize = std::min(maximumBlockSize, numSamples - blockStart);
+        const auto position = samplePosition.load(std::memory_order_relaxed);
+        
+        for (auto& slot : synths) {
+            slot.midi.clear();
+        }
+        
+        // hand out what's due in this block and keep the rest in order, shrinking the vector never frees anything
+        size_t kept = 0;
+        for (const auto& event : pending) {
+            if (event.samplePosition < position + blockSize) {
+                const auto offset = static_cast<int>(std::max<juce::int64>(0, event.samplePosition - position));
+                const auto message = event.isNoteOn ? juce::MidiMessage::noteOn(1, event.noteNumber, event.velocity) : juce::MidiMessage::noteOff(1, event.noteNumber);
+                synths[static_cast<size_t>(event.synthIndex)].midi.addEvent(message, offset);
+            } else {
+                pending[kept++] = event;
+            }
+        }
+        pending.resize(kept);
+        
+        for (auto& bus : busses) {
+            bus.buffer.clear(0, blockSize);
+        }
+        for (auto& slot : synths) {
+            slot.synth->renderNextBlock(busses[static_cast<size_t>(slot.busIndex)].buffer, slot.midi, 0, blockSize);
+        }
+        
+        AllocationTracker::StageScope effectsStage(AllocationStage::Effects);
+        mix.clear(0, blockSize);
+        returnBuffer.clear(0, blockSize);
+        const auto& kernels = DSPKernels::get();
+        for (auto& bus : busses) {
+            // refers to the bus buffer, a handful of channel pointers fits in AudioBuffer's preallocated space
+            juce::AudioBuffer<float> busBlock(bus.buffer.getArrayOfWritePointers(), bus.buffer.getNumChannels(), blockSize);
+            if (bus.effect != nullptr) {
+                bus.effect->process(busBlock);
+            }
+            for (int channel = 0; channel < mix.getNumChannels(); ++channel) {
+                const auto* busChannel = busBlock.getReadPointer(channel % busBlock.getNumChannels());
+                kernels.addScaled(mix.getWritePointer(channel), busChannel, 1.0f, blockSize);
+                if (bus.send > 0.0f) {
+                    kernels.addScaled(returnBuffer.getWritePointer(channel), busChannel, bus.send, blockSize);
+                }
+            }
+        }
+        if (auxReturn != nullptr) {
+            juce::AudioBuffer<float> returnBlock(returnBuffer.getArrayOfWritePointers(), returnBuffer.getNumChannels(), blockSize);
+            auxReturn->process(returnBlock);
+            for (int channel = 0; channel < mix.getNumChannels(); ++channel) {
+                kernels.addScaled(mix.getWritePointer(channel), returnBlock.getReadPointer(channel), 1.0f, blockSize);
+            }
+        }
+        if (masterBus != nullptr) {
+            masterBus->process(mix, 0, blockSize);
+        }
+        
+        for (int channel = 0; channel < numOutputChannels; ++channel) {
+            if (outputChannelData[channel] != nullptr) {
+                juce::FloatVectorOperations::copy(outputChannelData[channel] + blockStart, mix.getReadPointer(channel % mix.getNumChannels()), blockSize);
+            }
+        }
+        
+        samplePosition.store(position + blockSize, std::memory_order_release);
+    }
+}
+
+void RealtimePlayer::audioDeviceAboutToStart(juce::AudioIODevice* newDevice) {
+    device = newDevice;
+    prepare(newDevice->getCurrentBufferSizeSamples());
+}
+
+void RealtimePlayer::audioDeviceStopped() {
+    device = nullptr;
+}
+
+PlaybackStats RealtimePlayer::getStats() const {
+    PlaybackStats stats;
+    stats.callbacks = callbackCount.load(std::memory_order_acquire);
+    stats.xruns = xruns.load();
+    stats.droppedEvents = droppedEvents.load();
+    if (auto* currentDevice = device.load()) {
+        stats.deviceXruns = currentDevice->getXRunCount();
+    }
+    if (maximumBlockSize > 0) {
+        stats.budgetMs = maximumBlockSize * 1000.0 / sampleRate;
+    }
+    
+    const auto count = static_cast<size_t>(std::min<juce::int64>(stats.callbacks, TIMING_HISTORY));
+    if (count == 0) {
+        return stats;
+    }
+    
+    std::vector<float> timings(callbackMs.begin(), callbackMs.begin() + static_cast<std::ptrdiff_t>(count));
+    std::sort(timings.begin(), timings.end());
+    auto percentile = [&timings](double fraction) {
+        return static_cast<double>(timings[std::min(timings.size() - 1, static_cast<size_t>(fraction * timings.size()))]);
+    };
+    stats.p50Ms = percentile(0.5);
+    stats.p90Ms = percentile(0.9);
+    stats.p99Ms = percentile(0.99);
+    stats.maxMs = timings.back();
+    return stats;
+}
@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+    RealtimePlayer.h
+    Created: 19 Oct 2026 9:53:11am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <vector>
+#include "EffectProcessor.h"
+#include "MasterBusProcessor.h"
+
+struct PlaybackStats {
+    juce::int64 callbacks = 0;
+    // callbacks that took longer than the audio they produced lasts
+    int xruns = 0;
+    // what the device itself counted, -1 when there's no device or it can't tell
+    int deviceXruns = -1;
+    // events that didn't fit in the queue or the pending list
+    int droppedEvents = 0;
+    double budgetMs = 0.0;
+    double p50Ms = 0.0;
+    double p90Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+};
+
+/*
+    Plays synths live from a device callback. The control thread generates notes and schedules them with schedule,
+    the events cross over to the audio thread through a lock-free single producer, single consumer queue.
+
+    Everything the callback touches is set up in prepare, so it never allocates, locks, logs or repitches: the synth
+    voices have to be playing from PreparedSampleTables and the effects set to realtime while it runs. Logging is
+    muted on the callback's thread.
+ */
+class RealtimePlayer : public juce::AudioIODeviceCallback {
+public:
+    RealtimePlayer(double sampleRate);
+    
+    // setup, all of this has to happen before playback starts
+    // returns the index schedule takes for this synth
+    int addSynth(juce::Synthesiser* synth, int bus);
+    void setBusEffect(int bus, EffectProcessor* effect);
+    // how much of the bus, after its effect, goes into the aux return
+    void setBusSend(int bus, float level);
+    void setAuxReturn(EffectProcessor* effect);
+    // the busses are mixed through it before they reach the device
+    void setMasterBus(MasterBusProcessor* master);
+    void prepare(int maximumBlockSize);
+    
+    // control thread, samplePosition counts from the start of playback. false if the queue is full, try again later
+    bool schedule(int synthIndex, juce::int64 samplePosition, int noteNumber, float velocity, bool isNoteOn);
+    juce::int64 getSamplePosition() const { return samplePosition.load(); }
+    // the callback timings are only complete once playback has stopped
+    PlaybackStats getStats() const;
+    
+    void audioDeviceIOCallbackWithContext(const float* const* inputChannelData, int numInputChannels, float* const* outputChannelData, int numOutputChannels, int numSamples, const juce::AudioIODeviceCallbackContext& context) override;
+    void audioDeviceAboutToStart(juce::AudioIODevice* device) override;
+    void audioDeviceStopped() override;
+    
+private:
+    static constexpr int QUEUE_SIZE = 4096;
+    static constexpr int TIMING_HISTORY = 1 << 16;
+    static constexpr int MIDI_BUFFER_BYTES = 4096;
+    
+    struct ScheduledEvent {
+        juce::int64 samplePosition;
+        int synthIndex;
+        int noteNumber;
+        float velocity;
+        bool isNoteOn;
+    };
+    
+    struct SynthSlot {
+        juce::Synthesiser* synth;
+        int busIndex;
+        juce::MidiBuffer midi;
+    };
+    
+    struct Bus {
+        int identifier;
+        EffectProcessor* effect = nullptr;
+        float send = 0.0f;
+        juce::AudioBuffer<float> buffer;
+    };
+    
+    double sampleRate;
+    int maximumBlockSize = 0;
+    
+    juce::AbstractFifo fifo { QUEUE_SIZE };
+    std::vector<ScheduledEvent> queue;
+    // audio thread only, events taken off the queue that aren't due yet
+    std::vector<ScheduledEvent> pending;
+    
+    std::vector<SynthSlot> synths;
+    std::vector<Bus> busses;
+    EffectProcessor* auxReturn = nullptr;
+    juce::AudioBuffer<float> returnBuffer;
+    MasterBusProcessor* masterBus = nullptr;
+    juce::AudioBuffer<float> mix;
+    
+    std::atomic<juce::int64> samplePosition { 0 };
+    std::vector<float> callbackMs;
+    std::atomic<juce::int64> callbackCount { 0 };
+    std::atomic<int> xruns { 0 };
+    std::atomic<int> droppedEvents { 0 };
+    std::atomic<juce::AudioIODevice*> device { nullptr };
+    
+    int getBusIndex(int bus);
+    void renderBlock(float* const* outputChannelData, int numOutputChannels, int numSamples);
+};
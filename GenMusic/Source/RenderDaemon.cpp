@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    RenderDaemon.cpp
+    Created: 19 Oct 2026 9:39:26am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "RenderDaemon.h"
+#include <fmt/core.h>
+
+
+RenderDaemon::RenderDaemon(RenderEngine& engine) : engine(engine) {
+
+}
+
+void RenderDaemon::run(std::istream& input, std::ostream& output) {
+    output << "ready" << std::endl;
+
+    std::string line;
+    while (std::getline(input, line)) {
+        if (juce::String(line).trim().isEmpty()) {
+            continue;
+        }
+
+        const auto response = handle(line);
+        if (response.empty()) {
+            break;
+        }
+        output << response << std::endl;
+    }
+}
+
+std::string RenderDaemon::handle(const std::string& line) {
+    juce::StringArray tokens;
+    tokens.addTokens(juce::String(line), " ", "\"");
+    tokens.trim();
+    tokens.removeEmptyStrings();
+
+    const auto command = tokens[0];
+    if (command == "quit") {
+        return {};
+    }
+
+    if (command != "render" || tokens.size() < 3) {
+        return "error expected: render <seed> <wav path> [midi path]";
+    }
+
+    // getChildFile copes with both absolute paths and ones relative to where the daemon was started
+    const auto workingDirectory = juce::File::getCurrentWorkingDirectory();
+    const auto seed = tokens[1].unquoted().toStdString();
+    const auto outputFile = workingDirectory.getChildFile(tokens[2].unquoted());
+    const auto midiFile = tokens.size() > 3 ? workingDirectory.getChildFile(tokens[3].unquoted()) : juce::File();
+
+    try {
+        const auto timings = engine.render(seed, outputFile, midiFile);
+        return fmt::format("ok seed=\"{}\" generate_ms={:.2f} prepare_ms={:.2f} render_ms={:.2f} write_ms={:.2f} total_ms={:.2f}",
+                           seed, timings.generateMs, timings.prepareMs, timings.renderMs, timings.writeMs, timings.totalMs);
+    } catch (const std::exception& e) {
+        return fmt::format("error {}", e.what());
+    }
+}
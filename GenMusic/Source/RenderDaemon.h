@@ -0,0 +1,37 @@
+/*
+  ==============================================================================
+
+    RenderDaemon.h
+    Created: 19 Oct 2026 9:39:26am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <iostream>
+#include <string>
+#include "RenderEngine.h"
+
+/*
+    Keeps a RenderEngine warm and takes render jobs one line at a time:
+
+        render <seed> <wav path> [midi path]
+        quit
+
+    Arguments containing spaces go in double quotes. Once the engine is ready a "ready" line is written, then every
+    job is answered with a single "ok ..." line carrying its timings or an "error ..." line.
+ */
+class RenderDaemon {
+public:
+    RenderDaemon(RenderEngine& engine);
+
+    void run(std::istream& input, std::ostream& output);
+
+private:
+    RenderEngine& engine;
+
+    // returns the response line, or an empty string once the client asked to quit
+    std::string handle(const std::string& line);
+};
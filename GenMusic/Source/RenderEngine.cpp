@@ -0,0 +1,541 @@
+/*
+  ==============================================================================
+
+    RenderEngine.cpp
+    Created: 19 Oct 2026 9:39:26am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "RenderEngine.h"
+#include <numeric>
+#include <set>
+#include "Song.h"
+#include "Voices.h"
+#include "Utilities.h"
+#include "RepitchingSingleInstrumentSampleProcessor.h"
+#include "MultiInstrumentSampleProcessor.h"
+#include "MultiZoneSampleProcessor.h"
+#include "BankedSampleProcessor.h"
+#include "SyntheticSamples.h"
+#include "SampleLoader.h"
+#include "GrooveMachine.h"
+#include "ChordalGenerator.h"
+#include "MelodicGenerator.h"
+#include "NoteGenerator.h"
+#include "PreparedSampleTable.h"
+#include "SimulatedAudioClock.h"
+#include "AllocationTracker.h"
+#include "DSPKernels.h"
+
+// instrument ids in a sample bank
+const int MELODY_INSTRUMENT = 0;
+const int CHORD_INSTRUMENT = 1;
+const int DRUM_INSTRUMENT = 2;
+
+// the piano recorded at C2 and C4, keyed by the midi note each is rooted at. Melody and chords both play it
+const std::map<int, std::string> pianoSamples = {{36, "/Users/benjaminconn/workspace/lnrz/gen-music-script/sounds/JPIANO-C2.mp3"}, {60, "/Users/benjaminconn/workspace/lnrz/gen-music-script/sounds/JPIANO-C4.mp3"}};
+const std::map<int, std::string> drumSamples = {{0, "/Users/benjaminconn/workspace/lnrz/gen-music-script/sounds/samples/kick/KICK - nudy.wav"}, {1,"/Users/benjaminconn/workspace/lnrz/gen-music-script/sounds/samples/perc/PERC - stick.wav"}};
+
+
+// the drum kit can be swapped after construction, its synth is rebuilt with the same voices
+const int DRUM_VOICES = 4;
+const float DRUM_VOICE_GAIN = 0.5f;
+
+// block size the simulated clock calls back with, a typical device buffer
+const int SIMULATED_BLOCK_SIZE = 512;
+
+// the chance of each potential subdivision being played
+const std::vector<double> kickWeights = {1.0, 0.5, 0.5, 0.5, 0.7, 0.6, 0.5, 0.5};
+const std::vector<double> hitWeights = {0.15, 0.15, 0.5, 0.15, 0.15, 0.15, 0.8, 0.15};
+
+struct LoadedInstruments {
+    std::shared_ptr<SampleProcessor> melody;
+    std::shared_ptr<SampleProcessor> chords;
+    std::shared_ptr<SampleProcessor> drums;
+};
+
+// every sample file is decoded and conditioned at the same time rather than one processor after another
+static LoadedInstruments loadInstruments(const RenderSettings& settings) {
+    const auto conditioning = SampleConditioning::fromSettings(settings);
+    std::vector<std::string> filePaths;
+    for (const auto& pianoSample : pianoSamples) {
+        filePaths.push_back(pianoSample.second);
+    }
+    for (const auto& drumSample : drumSamples) {
+        filePaths.push_back(drumSample.second);
+    }
+    auto samples = SampleLoader::loadAll(filePaths, settings.sampleRate, conditioning);
+
+    LoadedInstruments instruments;
+    size_t index = 0;
+    // each note is repitched from the recording nearest to it, one shared instance so both synths share its caches
+    std::map<int, std::unique_ptr<RepitchingSingleInstrumentSampleProcessor>> pianoZones;
+    for (const auto& pianoSample : pianoSamples) {
+        pianoZones[pianoSample.first] = std::make_unique<RepitchingSingleInstrumentSampleProcessor>(std::move(samples[index++]), SampleLoader::getSampleIdentity(pianoSample.second, conditioning), pianoSample.first, settings);
+    }
+    instruments.melody = std::make_shared<MultiZoneSampleProcessor>(std::move(pianoZones));
+    instruments.chords = instruments.melody;
+
+    std::map<int, juce::AudioBuffer<float>> drums;
+    std::size_t drumIdentity = 0;
+    for (const auto& drumSample : drumSamples) {
+        drums[drumSample.first] = std::move(samples[index++]);
+        hashCombine(drumIdentity, SampleLoader::getSampleIdentity(drumSample.second, conditioning));
+    }
+    hashCombine(drumIdentity, settings.sampleRate);
+    instruments.drums = std::make_shared<MultiInstrumentSampleProcessor>(std::move(drums), drumIdentity, settings.compactSampleStorage);
+    return instruments;
+}
+
+RenderEngine::RenderEngine(const RenderSettings& settings, std::shared_ptr<SampleBank> bank) : settings(settings), melodicProcessor(settings), drumsProcessor(settings), auxReturn(settings), masterBus(settings.sampleRate), noteCache(settings.noteCacheBudgetBytes) {
+    logVerbose("DSP kernels: {}", DSPKernels::get().name);
+    if (bank) {
+        if (bank->getSampleRate() != settings.sampleRate) {
+            throw std::runtime_error("sample bank was baked at a different sample rate");
+        }
+        melodySampleProcessor = std::make_shared<BankedSampleProcessor>(bank, MELODY_INSTRUMENT);
+        chordSampleProcessor = std::make_shared<BankedSampleProcessor>(bank, CHORD_INSTRUMENT);
+        drumSampleProcessor = std::make_shared<BankedSampleProcessor>(bank, DRUM_INSTRUMENT);
+    } else if (settings.useSyntheticSamples) {
+        // still repitched like the files so the pipeline does the same work, just from tones rooted where they're pitched
+        std::size_t identity = 0;
+        hashCombine(identity, SyntheticSamples::VERSION);
+        melodySampleProcessor = std::make_shared<RepitchingSingleInstrumentSampleProcessor>(SyntheticSamples::tone(settings.sampleRate, 60), identity, 60, settings);
+        chordSampleProcessor = std::make_shared<RepitchingSingleInstrumentSampleProcessor>(SyntheticSamples::tone(settings.sampleRate, 36), identity, 36, settings);
+        std::map<int, juce::AudioBuffer<float>> drums;
+        drums[0] = SyntheticSamples::kick(settings.sampleRate);
+        drums[1] = SyntheticSamples::hit(settings.sampleRate);
+        hashCombine(identity, settings.sampleRate);
+        drumSampleProcessor = std::make_shared<MultiInstrumentSampleProcessor>(std::move(drums), identity, settings.compactSampleStorage);
+    } else {
+        auto instruments = loadInstruments(settings);
+        melodySampleProcessor = instruments.melody;
+        chordSampleProcessor = instruments.chords;
+        drumSampleProcessor = instruments.drums;
+    }
+
+    melodySynth.setCurrentPlaybackSampleRate(settings.sampleRate);
+    melodySynth.setNoteStealingEnabled(true);
+    for (int i = 0; i < 3; ++i) {
+        // 4 potential notes played at once
+        melodySynth.addVoice(new SampleVoice(melodySampleProcessor, i, 1.0f));
+    }
+    melodySynth.addSound(new DefaultSynthSound());
+
+    chordsSynth.setCurrentPlaybackSampleRate(settings.sampleRate);
+    chordsSynth.setNoteStealingEnabled(true);
+    for (int i = 0; i < 6; ++i) {
+        chordsSynth.addVoice(new SampleVoice(chordSampleProcessor, i, 0.8f));
+    }
+    chordsSynth.addSound(new DefaultSynthSound());
+
+    drumSynth.setCurrentPlaybackSampleRate(settings.sampleRate);
+    drumSynth.setNoteStealingEnabled(true);
+    for (int i = 0; i < DRUM_VOICES; ++i) {
+        drumSynth.addVoice(new SampleVoice(drumSampleProcessor, i, DRUM_VOICE_GAIN));
+    }
+    drumSynth.addSound(new DefaultSynthSound());
+}
+
+RenderEngine::SongGenerators::SongGenerators() = default;
+RenderEngine::SongGenerators::SongGenerators(SongGenerators&&) = default;
+RenderEngine::SongGenerators::~SongGenerators() = default;
+
+RenderEngine::SongGenerators RenderEngine::createGenerators(const std::string& seedString) {
+    SongGenerators generators;
+    const auto seed = generateRandomBytes(250, seedString);
+
+    int index = 0;
+
+    generators.bpm = 60 + (4 * (seed[index++] % 16));
+
+    const auto isMajor = static_cast<int>(seed[index++]) % 2 == 0;
+
+    const auto rootStart = index++;
+    const auto slice = std::vector<unsigned char>(seed.begin()+rootStart, seed.begin()+rootStart+4);
+    generators.chordal = std::make_unique<ChordalGenerator>(slice, isMajor);
+    const auto roots = generators.chordal->getRoots();
+
+
+    const auto chords = generators.chordal->getChords(roots);
+
+    generators.melody = std::make_unique<MelodicGenerator>(std::vector<unsigned char>(seed.begin()+index, seed.end()), roots, chords, isMajor);
+
+    generators.melodyNotes = generators.melody->generate();
+
+    for (const auto& chord: chords) {
+        for (const auto& note: chord.getNotes()) {
+            generators.chordNotes.push_back(note);
+        }
+    }
+
+    const auto& allMelodyNotes = generators.melodyNotes;
+    // the kick reads the same seed bytes it always has, the perc lane follows straight after it
+    const auto kickSeedOffset = static_cast<int>(allMelodyNotes.size()) + NoteGenerator::LOOPS * 4;
+    const auto hitSeedOffset = kickSeedOffset + static_cast<int>(kickWeights.size());
+    generators.drums = std::make_unique<GrooveMachine>(seed, 4.0, std::vector<GrooveLane>{
+        {0, kickWeights, {0.5}, {3}, kickSeedOffset},
+        {1, hitWeights, {0.5}, {1}, hitSeedOffset},
+    });
+
+    return generators;
+}
+
+std::vector<std::pair<int, std::pair<NoteGenerator*, juce::Synthesiser*>>> RenderEngine::routeGenerators(SongGenerators& generators) {
+    std::vector<std::pair<int, std::pair<NoteGenerator*, juce::Synthesiser*>>> noteGenerators;
+    noteGenerators.push_back(std::make_pair(MELODIC_BUS, std::make_pair(generators.melody.get(), &melodySynth)));
+    noteGenerators.push_back(std::make_pair(MELODIC_BUS, std::make_pair(generators.chordal.get(), &chordsSynth)));
+    noteGenerators.push_back(std::make_pair(DRUM_BUS, std::make_pair(generators.drums.get(), &drumSynth)));
+    return noteGenerators;
+}
+
+void RenderEngine::setDrumSamples(std::shared_ptr<SampleProcessor> samples) {
+    if (samples == nullptr) {
+        throw std::invalid_argument("The drums need a sample processor");
+    }
+    drumSampleProcessor = std::move(samples);
+    drumSynth.clearVoices();
+    for (int i = 0; i < DRUM_VOICES; ++i) {
+        drumSynth.addVoice(new SampleVoice(drumSampleProcessor, i, DRUM_VOICE_GAIN));
+    }
+}
+
+void RenderEngine::setBusEffect(int bus, EffectProcessor* effect) {
+    if (bus != MELODIC_BUS && bus != DRUM_BUS) {
+        throw std::invalid_argument("There's no bus " + std::to_string(bus));
+    }
+    if (effect == nullptr) {
+        busEffects.erase(bus);
+    } else {
+        busEffects[bus] = effect;
+    }
+}
+
+BusRouting RenderEngine::getBusRouting() {
+    BusRouting routing;
+    routing.effects[MELODIC_BUS] = &melodicProcessor;
+    routing.effects[DRUM_BUS] = &drumsProcessor;
+    for (auto& effect : busEffects) {
+        routing.effects[effect.first] = effect.second;
+    }
+    // the melodic bus used to own its reverb, which ran the dry signal at twice its 0.7 dry level. This send keeps
+    // the wet to dry balance about where that left it, the drums stay dry
+    routing.sends[MELODIC_BUS] = 0.7f;
+    routing.auxReturn = &auxReturn;
+    return routing;
+}
+
+static void reportAllocations(const std::string& seedString) {
+    if (AllocationTracker::isEnabled()) {
+        // stderr so it stays out of the daemon's protocol
+        fmt::println(stderr, "Allocations for \"{}\":\n{}", seedString, AllocationTracker::getSummary());
+    }
+}
+
+RenderTimings RenderEngine::render(const std::string& seedString, const juce::File& outputFile, const juce::File& midiFile) {
+    // the writer takes the whole song at once, so it's kept in songBuffer until then
+    return renderSong(seedString, [this](const juce::AudioBuffer<float>& mix) { songBuffer.makeCopyOf(mix, true); }, outputFile, midiFile);
+}
+
+RenderTimings RenderEngine::render(const std::string& seedString, juce::AudioBuffer<float>& output) {
+    return renderSong(seedString, [&output](const juce::AudioBuffer<float>& mix) { output.makeCopyOf(mix, true); }, juce::File(), juce::File());
+}
+
+RenderTimings RenderEngine::render(const std::string& seedString, const Song::MixConsumer& consumeMix) {
+    return renderSong(seedString, consumeMix, juce::File(), juce::File());
+}
+
+RenderTimings RenderEngine::renderSong(const std::string& seedString, const Song::MixConsumer& consumeMix, const juce::File& outputFile, const juce::File& midiFile) {
+    RenderTimings timings;
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+    auto lapTime = startTime;
+    // each lap also moves the allocation accounting on to the next stage
+    auto lap = [&lapTime](AllocationStage nextStage) {
+        const auto now = juce::Time::getMillisecondCounterHiRes();
+        const auto elapsed = now - lapTime;
+        lapTime = now;
+        AllocationTracker::setStage(nextStage);
+        return elapsed;
+    };
+
+    AllocationTracker::beginRender();
+    const auto previousStage = AllocationTracker::setStage(AllocationStage::Generate);
+
+    resetForNextRender();
+
+    auto generators = createGenerators(seedString);
+    for (auto note : generators.drums->generate()) {
+        logVerbose("start {} {} {} {}", note.startTimeInBeats, note.velocity, note.durationInBeats, note.midiNoteNumber);
+    }
+    timings.generateMs = lap(AllocationStage::Prepare);
+
+    prepareNotes(*melodySampleProcessor, generators.melodyNotes);
+    prepareNotes(*chordSampleProcessor, generators.chordNotes);
+    timings.prepareMs = lap(AllocationStage::Render);
+
+    auto song = Song(generators.bpm, settings.sampleRate);
+    auto noteGenerators = routeGenerators(generators);
+
+    song.generateSong(noteGenerators, getBusRouting(), consumeMix, &stemCache, &masterBus, settings.noteCacheBudgetBytes > 0 ? &noteCache : nullptr);
+    timings.renderMs = lap(AllocationStage::Write);
+
+    if (outputFile != juce::File()) {
+        song.renderToFile(outputFile, songBuffer);
+    }
+    if (midiFile != juce::File()) {
+        std::vector<NoteGenerator*> allGenerators;
+        for (auto& noteGenerator: noteGenerators) {
+            allGenerators.push_back(noteGenerator.second.first);
+        }
+        auto midiSequence = song.generateMidi(allGenerators);
+        song.renderToMidiFile(midiFile, midiSequence);
+    }
+    timings.writeMs = lap(previousStage);
+
+    timings.totalMs = lapTime - startTime;
+    reportAllocations(seedString);
+    return timings;
+}
+
+RenderTimings RenderEngine::renderStream(const std::string& seedString, const juce::File& outputFile, int lengthInBars) {
+    RenderTimings timings;
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+    AllocationTracker::beginRender();
+    const auto previousStage = AllocationTracker::setStage(AllocationStage::Generate);
+
+    resetForNextRender();
+    auto generators = createGenerators(seedString);
+    timings.generateMs = juce::Time::getMillisecondCounterHiRes() - startTime;
+    AllocationTracker::setStage(AllocationStage::Prepare);
+
+    // the stream wanders off the first loop's notes, anything it hasn't prepared gets repitched as it's first played
+    prepareNotes(*melodySampleProcessor, generators.melodyNotes);
+    prepareNotes(*chordSampleProcessor, generators.chordNotes);
+    timings.prepareMs = juce::Time::getMillisecondCounterHiRes() - startTime - timings.generateMs;
+    // each window's generating, effects and writing are scoped inside the stream
+    AllocationTracker::setStage(AllocationStage::Render);
+
+    auto song = Song(generators.bpm, settings.sampleRate);
+    song.renderStreamToFile(outputFile, routeGenerators(generators), getBusRouting(), &masterBus, lengthInBars * NoteGenerator::BEATS_PER_BAR);
+    AllocationTracker::setStage(previousStage);
+
+    // generation, rendering and writing are interleaved a window at a time so they're only reported together
+    timings.totalMs = juce::Time::getMillisecondCounterHiRes() - startTime;
+    timings.renderMs = timings.totalMs - timings.generateMs - timings.prepareMs;
+    reportAllocations(seedString);
+    return timings;
+}
+
+static void setPreparedSamples(juce::Synthesiser& synth, std::shared_ptr<const PreparedSampleTable> table) {
+    for (int i = 0; i < synth.getNumVoices(); ++i) {
+        if (auto* voice = dynamic_cast<SampleVoice*>(synth.getVoice(i))) {
+            voice->setPreparedSamples(table);
+        }
+    }
+}
+
+PlaybackStats RenderEngine::play(const std::string& seedString, int lengthInBars, bool useAudioDevice) {
+    AllocationTracker::beginRender();
+    resetForNextRender();
+    auto generators = createGenerators(seedString);
+    auto noteGenerators = routeGenerators(generators);
+    
+    // the audio thread only reads from these, notes are repitched into them here before they're scheduled
+    std::map<juce::Synthesiser*, std::shared_ptr<PreparedSampleTable>> tables = {
+        {&melodySynth, std::make_shared<PreparedSampleTable>(melodySampleProcessor)},
+        {&chordsSynth, std::make_shared<PreparedSampleTable>(chordSampleProcessor)},
+        {&drumSynth, std::make_shared<PreparedSampleTable>(drumSampleProcessor)},
+    };
+    
+    RealtimePlayer player(settings.sampleRate);
+    std::map<juce::Synthesiser*, int> synthIndices;
+    for (auto& noteGenerator : noteGenerators) {
+        auto* synth = noteGenerator.second.second;
+        if (synthIndices.find(synth) == synthIndices.end()) {
+            synthIndices[synth] = player.addSynth(synth, noteGenerator.first);
+        }
+        noteGenerator.second.first->resetStream();
+    }
+    const auto routing = getBusRouting();
+    for (auto& effect : routing.effects) {
+        player.setBusEffect(effect.first, effect.second);
+        player.setBusSend(effect.first, routing.getSend(effect.first));
+    }
+    player.setAuxReturn(routing.auxReturn);
+    player.setMasterBus(&masterBus);
+    
+    for (auto& table : tables) {
+        setPreparedSamples(*table.first, table.second);
+    }
+    auto setEffectsRealtime = [&](bool isRealtime) {
+        for (auto& effect : routing.effects) {
+            if (effect.second != nullptr) {
+                effect.second->setRealtime(isRealtime);
+            }
+        }
+        if (routing.auxReturn != nullptr) {
+            routing.auxReturn->setRealtime(isRealtime);
+        }
+    };
+    setEffectsRealtime(true);
+    // the engine goes back to offline rendering however playback ends
+    const juce::ScopeGuard restore { [&] {
+        for (auto& table : tables) {
+            setPreparedSamples(*table.first, nullptr);
+        }
+        setEffectsRealtime(false);
+    } };
+    
+    juce::AudioDeviceManager deviceManager;
+    std::unique_ptr<SimulatedAudioClock> clock;
+    auto startAudio = [&]() {
+        if (useAudioDevice) {
+            const auto error = deviceManager.initialiseWithDefaultDevices(0, 2);
+            if (error.isNotEmpty()) {
+                throw std::runtime_error("Could not open an audio device: " + error.toStdString());
+            }
+            auto setup = deviceManager.getAudioDeviceSetup();
+            setup.sampleRate = settings.sampleRate;
+            deviceManager.setAudioDeviceSetup(setup, true);
+            auto* device = deviceManager.getCurrentAudioDevice();
+            if (device == nullptr || device->getCurrentSampleRate() != settings.sampleRate) {
+                throw std::runtime_error("The audio device won't run at the render sample rate");
+            }
+            // audioDeviceAboutToStart prepares the player for the device's buffer size
+            deviceManager.addAudioCallback(&player);
+        } else {
+            player.prepare(SIMULATED_BLOCK_SIZE);
+            clock = std::make_unique<SimulatedAudioClock>(player, settings.sampleRate, SIMULATED_BLOCK_SIZE);
+            clock->start();
+        }
+    };
+    
+    const double samplesPerBeat = (60.0 / generators.bpm) * settings.sampleRate;
+    const double windowInBeats = NoteGenerator::BEATS_PER_BAR;
+    const double totalBeats = lengthInBars * NoteGenerator::BEATS_PER_BAR;
+    // stay a couple of bars ahead of the audio, long enough to repitch a window's new notes before they're due
+    const auto lookaheadSamples = static_cast<juce::int64>(2 * windowInBeats * samplesPerBeat);
+    
+    auto schedule = [&player](int synthIndex, juce::int64 position, int noteNumber, float velocity, bool isNoteOn) {
+        while (!player.schedule(synthIndex, position, noteNumber, velocity, isNoteOn)) {
+            juce::Thread::sleep(1);
+        }
+    };
+    
+    bool started = false;
+    for (double windowStart = 0.0; windowStart < totalBeats; windowStart += windowInBeats) {
+        const auto windowStartSample = static_cast<juce::int64>(windowStart * samplesPerBeat);
+        if (!started && windowStartSample > lookaheadSamples) {
+            startAudio();
+            started = true;
+        }
+        while (started && windowStartSample > player.getSamplePosition() + lookaheadSamples) {
+            juce::Thread::sleep(5);
+        }
+        
+        for (auto& noteGenerator : noteGenerators) {
+            auto* synth = noteGenerator.second.second;
+            auto& table = *tables.at(synth);
+            const auto synthIndex = synthIndices.at(synth);
+            std::vector<Note> notes;
+            {
+                AllocationTracker::StageScope stage(AllocationStage::Generate);
+                notes = noteGenerator.second.first->generateWindow(windowStart, std::min(windowInBeats, totalBeats - windowStart));
+            }
+            for (const auto& note : notes) {
+                {
+                    AllocationTracker::StageScope stage(AllocationStage::Prepare);
+                    table.prepare(note.midiNoteNumber);
+                }
+                const auto startSample = static_cast<juce::int64>(note.startTimeInBeats * samplesPerBeat);
+                const auto endSample = startSample + static_cast<juce::int64>(note.durationInBeats * samplesPerBeat);
+                schedule(synthIndex, startSample, note.midiNoteNumber, note.velocity, true);
+                schedule(synthIndex, endSample, note.midiNoteNumber, 0.0f, false);
+            }
+        }
+    }
+    if (!started) {
+        startAudio();
+    }
+    
+    // the same two second tail an offline render leaves
+    const auto endOfPlayback = static_cast<juce::int64>(totalBeats * samplesPerBeat + settings.sampleRate * 2);
+    while (player.getSamplePosition() < endOfPlayback) {
+        juce::Thread::sleep(10);
+    }
+    
+    if (clock != nullptr) {
+        clock->stop();
+    }
+    const auto stats = player.getStats();
+    deviceManager.removeAudioCallback(&player);
+    deviceManager.closeAudioDevice();
+    reportAllocations(seedString);
+    return stats;
+}
+
+void RenderEngine::prepareNotes(SampleProcessor& processor, const std::vector<Note>& notes) {
+    std::set<int> noteNumbers;
+    for (const auto& note : notes) {
+        noteNumbers.insert(note.midiNoteNumber);
+    }
+    for (auto noteNumber : noteNumbers) {
+        processor.getAudioForNoteNumber(noteNumber);
+    }
+}
+
+void RenderEngine::resetForNextRender() {
+    for (auto* synth : {&melodySynth, &chordsSynth, &drumSynth}) {
+        synth->allNotesOff(0, false);
+    }
+    melodicProcessor.reset();
+    drumsProcessor.reset();
+    for (auto& effect : busEffects) {
+        effect.second->reset();
+    }
+    auxReturn.reset();
+    masterBus.reset();
+}
+
+RepitchCacheStats RenderEngine::getNoteCacheStats() const {
+    return noteCache.getStats();
+}
+
+RepitchCacheStats RenderEngine::getRepitchCacheStats() const {
+    RepitchCacheStats stats;
+    // melody and chords can be the same instrument, it's only counted once
+    std::set<const SampleProcessor*> counted;
+    for (const auto& processor : {melodySampleProcessor, chordSampleProcessor, drumSampleProcessor}) {
+        if (!counted.insert(processor.get()).second) {
+            continue;
+        }
+        if (auto* repitching = dynamic_cast<RepitchingSingleInstrumentSampleProcessor*>(processor.get())) {
+            stats += repitching->getCacheStats();
+        } else if (auto* multiZone = dynamic_cast<MultiZoneSampleProcessor*>(processor.get())) {
+            stats += multiZone->getCacheStats();
+        }
+    }
+    return stats;
+}
+
+void RenderEngine::bakeSampleBank(const juce::File& outputFile, const RenderSettings& settings) {
+    // every note the generators can play, a banked render has to sound the same as one repitching on the fly
+    auto notesIn = [](std::pair<int, int> range) {
+        std::vector<int> notes(static_cast<size_t>(range.second - range.first + 1));
+        std::iota(notes.begin(), notes.end(), range.first);
+        return notes;
+    };
+    std::vector<int> drumNotes;
+    for (const auto& drumSample : drumSamples) {
+        drumNotes.push_back(drumSample.first);
+    }
+
+    const auto instruments = loadInstruments(settings);
+    SampleBank::bake(outputFile, settings.sampleRate, {
+        {MELODY_INSTRUMENT, instruments.melody, notesIn(MelodicGenerator::getNoteRange())},
+        {CHORD_INSTRUMENT, instruments.chords, notesIn(ChordalGenerator::getNoteRange())},
+        {DRUM_INSTRUMENT, instruments.drums, drumNotes},
+    });
+}
@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    RenderEngine.h
+    Created: 19 Oct 2026 9:39:26am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Note.h"
+#include "RenderSettings.h"
+#include "SampleProcessor.h"
+#include "SampleBank.h"
+#include "MelodicComponentsEffectProcessor.h"
+#include "DrumsEffectProcessor.h"
+#include "AuxReturnEffectProcessor.h"
+#include "BusRouting.h"
+#include "StemCache.h"
+#include "RealtimePlayer.h"
+#include "MasterBusProcessor.h"
+#include "RepitchCache.h"
+#include "RenderedNoteCache.h"
+#include "Song.h"
+
+class NoteGenerator;
+class ChordalGenerator;
+class MelodicGenerator;
+class GrooveMachine;
+
+struct RenderTimings {
+    double generateMs = 0.0;
+    // repitching any notes the sample caches haven't seen yet
+    double prepareMs = 0.0;
+    double renderMs = 0.0;
+    double writeMs = 0.0;
+    double totalMs = 0.0;
+};
+
+/*
+    Owns everything that is expensive to set up for a render: the decoded samples and their repitch caches, the
+    synthesisers and the prepared effect chains. Build one and call render as often as needed, each call only
+    pays for generating and rendering its own song.
+ */
+class RenderEngine {
+public:
+    RenderEngine(const RenderSettings& settings, std::shared_ptr<SampleBank> bank = nullptr);
+
+    // midiFile can be left as juce::File() to skip writing the midi
+    RenderTimings render(const std::string& seedString, const juce::File& outputFile, const juce::File& midiFile);
+    // the mastered stereo song, output is resized to fit it. writeMs is left at zero
+    RenderTimings render(const std::string& seedString, juce::AudioBuffer<float>& output);
+    // the same, handing consumeMix the mix where the render left it for anything that wants it in a layout of its own
+    RenderTimings render(const std::string& seedString, const Song::MixConsumer& consumeMix);
+
+    // renders the seed's generators as an endless stream cut off after lengthInBars, a window at a time
+    RenderTimings renderStream(const std::string& seedString, const juce::File& outputFile, int lengthInBars);
+
+    // plays the seed's stream live for lengthInBars, through the default audio device or, without one, a simulated
+    // clock that paces the callback the same way
+    PlaybackStats play(const std::string& seedString, int lengthInBars, bool useAudioDevice);
+
+    // hits, misses, evictions and resident notes across every repitching sample processor
+    RepitchCacheStats getRepitchCacheStats() const;
+    // the same for the whole notes rendered songs are built from
+    RepitchCacheStats getNoteCacheStats() const;
+
+    static void bakeSampleBank(const juce::File& outputFile, const RenderSettings& settings);
+
+    // the busses the generators are routed to
+    static constexpr int MELODIC_BUS = 0;
+    static constexpr int DRUM_BUS = 1;
+
+    // Swap what one bus sounds like and leave everything else alone. The next render of a seed re-renders only that
+    // bus and remixes the others from the stem cache
+    void setDrumSamples(std::shared_ptr<SampleProcessor> samples);
+    // in place of the bus's own effect, nullptr puts it back. Not owned, it has to outlive the engine's renders
+    void setBusEffect(int bus, EffectProcessor* effect);
+
+    // how many busses (and aux returns) came out of the stem cache rather than being rendered
+    int getStemCacheHits() const { return stemCache.getHits(); }
+    int getStemCacheMisses() const { return stemCache.getMisses(); }
+
+private:
+    // everything generated from one seed, the melody is built on the chordal generator's roots and chords
+    struct SongGenerators {
+        double bpm;
+        std::unique_ptr<ChordalGenerator> chordal;
+        std::unique_ptr<MelodicGenerator> melody;
+        std::unique_ptr<GrooveMachine> drums;
+        std::vector<Note> melodyNotes;
+        std::vector<Note> chordNotes;
+
+        SongGenerators();
+        SongGenerators(SongGenerators&&);
+        ~SongGenerators();
+    };
+
+    RenderSettings settings;
+
+    std::shared_ptr<SampleProcessor> melodySampleProcessor;
+    std::shared_ptr<SampleProcessor> chordSampleProcessor;
+    std::shared_ptr<SampleProcessor> drumSampleProcessor;
+
+    juce::Synthesiser melodySynth;
+    juce::Synthesiser chordsSynth;
+    juce::Synthesiser drumSynth;
+
+    MelodicComponentEffectProcessor melodicProcessor;
+    DrumsEffectProcessor drumsProcessor;
+    // the one reverb and chorus every bus sends into
+    AuxReturnEffectProcessor auxReturn;
+    MasterBusProcessor masterBus;
+    // replacements for the busses' own effects, see setBusEffect
+    std::map<int, EffectProcessor*> busEffects;
+    
+    // bus renders from earlier jobs, a re-render that only touches one bus reuses the others
+    StemCache stemCache;
+    // shared by every song this engine renders, a note only changes when its voice or timing does
+    RenderedNoteCache noteCache;
+    // the mix of a song rendered to a file, kept so the next one doesn't allocate its own
+    juce::AudioBuffer<float> songBuffer;
+
+    SongGenerators createGenerators(const std::string& seedString);
+    // which bus and synth each generator plays through
+    std::vector<std::pair<int, std::pair<NoteGenerator*, juce::Synthesiser*>>> routeGenerators(SongGenerators& generators);
+    BusRouting getBusRouting();
+
+    // either file can be juce::File() to skip writing it, writing outputFile needs consumeMix to have filled songBuffer
+    RenderTimings renderSong(const std::string& seedString, const Song::MixConsumer& consumeMix, const juce::File& outputFile, const juce::File& midiFile);
+    void prepareNotes(SampleProcessor& processor, const std::vector<Note>& notes);
+    // puts the synths and effects back to how a fresh engine has them so renders don't bleed into each other
+    void resetForNextRender();
+};
@@ -0,0 +1,38 @@
+/*
+  ==============================================================================
+
+    RenderSettings.h
+    Created: 19 Oct 2026 9:37:57am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cstddef>
+#include <string>
+
+struct RenderSettings {
+    double sampleRate = 48000.0;
+    // preview renders trade quality for speed, repitching uses the faster engine and the effect chains are lighter
+    bool isPreview = false;
+    // generated tones instead of the sample files, for load tests and machines without the sounds
+    bool useSyntheticSamples = false;
+    // sample processors cache their audio as 16 bit, half the memory for a quantisation floor ~90dB under each
+    // sample's peak
+    bool compactSampleStorage = false;
+    // what each repitching processor may hold on to, the least recently used notes are repitched again past it
+    std::size_t repitchCacheBudgetBytes = 256 * 1024 * 1024;
+    // whole rendered notes, enveloped and ready to be added in wherever they repeat. 0 renders every note through the
+    // synths
+    std::size_t noteCacheBudgetBytes = 64 * 1024 * 1024;
+    // samples are always trimmed and dc corrected as they load, this also brings every one to the same peak level
+    bool normaliseSamples = false;
+    // an impulse response file the aux return convolves with in place of its algorithmic reverb, empty keeps the
+    // algorithmic one. With synthetic samples the response is generated too and this only has to be set
+    std::string impulseResponsePath;
+
+    // for the audition UI, roughly twice as fast as a final render
+    static RenderSettings forPreview() { return {22050.0, true}; }
+    static RenderSettings forFinal() { return {48000.0, false}; }
+};
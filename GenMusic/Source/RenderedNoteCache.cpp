@@ -0,0 +1,35 @@
+/*
+  ==============================================================================
+
+    RenderedNoteCache.cpp
+    Created: 19 Oct 2026 10:31:07am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "RenderedNoteCache.h"
+
+RenderedNoteCache::RenderedNoteCache(std::size_t budgetBytes) : notes(budgetBytes) {
+
+}
+
+std::shared_ptr<const juce::AudioBuffer<float>> RenderedNoteCache::find(const Key& key) {
+    const juce::ScopedLock scopedLock(lock);
+    return notes.find(key).audio;
+}
+
+void RenderedNoteCache::store(const Key& key, std::shared_ptr<const juce::AudioBuffer<float>> note) {
+    const juce::ScopedLock scopedLock(lock);
+    notes.store(key, {std::move(note), nullptr});
+}
+
+void RenderedNoteCache::clear() {
+    const juce::ScopedLock scopedLock(lock);
+    notes.clear();
+}
+
+RepitchCacheStats RenderedNoteCache::getStats() const {
+    const juce::ScopedLock scopedLock(lock);
+    return notes.getStats();
+}
@@ -0,0 +1,50 @@
+/*
+  ==============================================================================
+
+    RenderedNoteCache.h
+    Created: 19 Oct 2026 10:31:07am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <memory>
+#include <tuple>
+#include "RepitchCache.h"
+
+/*
+    Whole notes as a voice plays them, gain and envelope applied and release included, keyed by everything that
+    decides how one sounds: the voice, the pitch, the velocity, how long the key is held and the sample rate. A song
+    repeats the same few notes over and over, so most of them are rendered once and then just added in where they
+    play. Shares RepitchCache's byte budget and least recently used eviction, and locks around it so sources rendering
+    on different threads can share one.
+ */
+class RenderedNoteCache {
+public:
+    struct Key {
+        std::size_t voiceIdentity;
+        int noteNumber;
+        int velocity;
+        int durationInSamples;
+        double sampleRate;
+
+        bool operator<(const Key& other) const {
+            return std::tie(voiceIdentity, noteNumber, velocity, durationInSamples, sampleRate) < std::tie(other.voiceIdentity, other.noteNumber, other.velocity, other.durationInSamples, other.sampleRate);
+        }
+    };
+
+    explicit RenderedNoteCache(std::size_t budgetBytes);
+
+    // nullptr on a miss
+    std::shared_ptr<const juce::AudioBuffer<float>> find(const Key& key);
+    void store(const Key& key, std::shared_ptr<const juce::AudioBuffer<float>> note);
+    void clear();
+
+    RepitchCacheStats getStats() const;
+
+private:
+    mutable juce::CriticalSection lock;
+    RepitchCache<Key> notes;
+};
@@ -0,0 +1,30 @@
+/*
+  ==============================================================================
+
+    RepitchCache.cpp
+    Created: 19 Oct 2026 10:22:20am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "RepitchCache.h"
+
+std::size_t CachedNote::getSizeInBytes() const {
+    if (compact != nullptr) {
+        return compact->getSizeInBytes();
+    }
+    if (audio != nullptr) {
+        return static_cast<std::size_t>(audio->getNumChannels()) * static_cast<std::size_t>(audio->getNumSamples()) * sizeof(float);
+    }
+    return 0;
+}
+
+RepitchCacheStats& RepitchCacheStats::operator+=(const RepitchCacheStats& other) {
+    hits += other.hits;
+    misses += other.misses;
+    evictions += other.evictions;
+    residentBytes += other.residentBytes;
+    residentNotes += other.residentNotes;
+    return *this;
+}
@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    RepitchCache.h
+    Created: 19 Oct 2026 10:22:20am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <list>
+#include <map>
+#include <memory>
+#include "CompactAudioBuffer.h"
+
+// one repitched note, audio or compact is set depending on how the processor stores its notes
+struct CachedNote {
+    std::shared_ptr<const juce::AudioBuffer<float>> audio;
+    std::shared_ptr<const CompactAudioBuffer> compact;
+
+    bool isEmpty() const { return audio == nullptr && compact == nullptr; }
+    std::size_t getSizeInBytes() const;
+};
+
+struct RepitchCacheStats {
+    juce::int64 hits = 0;
+    juce::int64 misses = 0;
+    juce::int64 evictions = 0;
+    std::size_t residentBytes = 0;
+    int residentNotes = 0;
+
+    RepitchCacheStats& operator+=(const RepitchCacheStats& other);
+};
+
+/*
+    Repitched notes kept under a byte budget, the least recently used note goes first once a new one would push the
+    total over it. Hot pitches stay resident however many seeds a long lived process works through, and anything
+    evicted is just repitched again the next time it's asked for. A voice still playing an evicted note keeps it
+    alive through its shared pointer. Keyed by note number for a repitching processor, anything else that needs the same
+    policy keys it by a struct of whatever decides the note, ordered so two keys only match when every field does.
+    Not thread safe, the owner locks around it.
+ */
+template <typename Key>
+class RepitchCache {
+public:
+    explicit RepitchCache(std::size_t budgetBytes) : budgetBytes(budgetBytes) {
+
+    }
+
+    // an empty CachedNote on a miss, a hit makes the note the most recently used
+    CachedNote find(const Key& key) {
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            stats.misses++;
+            return {};
+        }
+
+        stats.hits++;
+        recency.splice(recency.begin(), recency, it->second.recency);
+        return it->second.note;
+    }
+
+    // the note just stored is never evicted, even when it's bigger than the whole budget on its own
+    void store(const Key& key, CachedNote note) {
+        auto existing = entries.find(key);
+        if (existing != entries.end()) {
+            stats.residentBytes -= existing->second.bytes;
+            recency.erase(existing->second.recency);
+            entries.erase(existing);
+        }
+
+        const auto bytes = note.getSizeInBytes();
+        recency.push_front(key);
+        entries[key] = {std::move(note), bytes, recency.begin()};
+        stats.residentBytes += bytes;
+
+        while (stats.residentBytes > budgetBytes && recency.size() > 1) {
+            auto oldest = entries.find(recency.back());
+            stats.residentBytes -= oldest->second.bytes;
+            entries.erase(oldest);
+            recency.pop_back();
+            stats.evictions++;
+        }
+    }
+
+    void clear() {
+        entries.clear();
+        recency.clear();
+        stats.residentBytes = 0;
+    }
+
+    RepitchCacheStats getStats() const {
+        auto current = stats;
+        current.residentNotes = static_cast<int>(entries.size());
+        return current;
+    }
+
+    std::size_t getBudgetBytes() const { return budgetBytes; }
+
+private:
+    struct Entry {
+        CachedNote note;
+        std::size_t bytes;
+        typename std::list<Key>::iterator recency;
+    };
+
+    std::size_t budgetBytes;
+    std::map<Key, Entry> entries;
+    // most recently used first
+    std::list<Key> recency;
+    RepitchCacheStats stats;
+};
@@ -14,37 +14,28 @@
 #include <rubberband/RubberBandStretcher.h>
 #include <fmt/core.h>
 #include "Note.h"
+#include "SampleLoader.h"
+#include "Utilities.h"
+#include "AudioBufferPool.h"
 
 
-RepitchingSingleInstrumentSampleProcessor::RepitchingSingleInstrumentSampleProcessor(std::string filePath, int rootMidiNote) : rootMidiNote(rootMidiNote) {
-    // Load the audio file
-    juce::File file(filePath);
-    juce::AudioFormatManager formatManager;
-    formatManager.registerBasicFormats();
-    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
-    
-    if (reader.get() != nullptr) {
-        originalAudioSampleBuffer.setSize((int)reader->numChannels, (int)reader->lengthInSamples);
-        reader->read(&originalAudioSampleBuffer, 0, (int)reader->lengthInSamples, 0, true, true);
-    }
-    
-    // Create the stretcher
-    stretcher = std::make_shared<RubberBand::RubberBandStretcher>(44100, 2, RubberBand::RubberBandStretcher::OptionProcessOffline + RubberBand::RubberBandStretcher::Option::OptionPitchHighConsistency + RubberBand::RubberBandStretcher::Option::OptionEngineFiner);
+// Load the audio file, already conditioned and converted to the render sample rate
+RepitchingSingleInstrumentSampleProcessor::RepitchingSingleInstrumentSampleProcessor(std::string filePath, int rootMidiNote, const RenderSettings& settings) : RepitchingSingleInstrumentSampleProcessor(SampleLoader::load(filePath, settings.sampleRate, SampleConditioning::fromSettings(settings)), SampleLoader::getSampleIdentity(filePath, SampleConditioning::fromSettings(settings)), rootMidiNote, settings) {
 }
 
-RepitchingSingleInstrumentSampleProcessor::RepitchingSingleInstrumentSampleProcessor(std::string filePath, int rootMidiNote, std::vector<Note> notes) : rootMidiNote(rootMidiNote) {
-    juce::File file(filePath);
-    juce::AudioFormatManager formatManager;
-    formatManager.registerBasicFormats();
-    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
-    
-    if (reader.get() != nullptr) {
-        originalAudioSampleBuffer.setSize((int)reader->numChannels, (int)reader->lengthInSamples);
-        reader->read(&originalAudioSampleBuffer, 0, (int)reader->lengthInSamples, 0, true, true);
-    }
+RepitchingSingleInstrumentSampleProcessor::RepitchingSingleInstrumentSampleProcessor(juce::AudioBuffer<float> sample, std::size_t sampleIdentity, int rootMidiNote, const RenderSettings& settings) : originalAudioSampleBuffer(std::move(sample)), cache(settings.repitchCacheBudgetBytes), compactStorage(settings.compactSampleStorage), rootMidiNote(rootMidiNote) {
+    identity = sampleIdentity;
+    hashCombine(identity, rootMidiNote);
+    hashCombine(identity, settings.sampleRate);
+    hashCombine(identity, settings.isPreview);
+    hashCombine(identity, compactStorage);
     
-    // Create the stretcher
-    stretcher = std::make_shared<RubberBand::RubberBandStretcher>(44100, 2, RubberBand::RubberBandStretcher::OptionProcessOffline + RubberBand::RubberBandStretcher::Option::OptionPitchHighConsistency + RubberBand::RubberBandStretcher::Option::OptionEngineFiner);
+    // Create the stretcher, previews use the cheaper engine
+    const auto engine = settings.isPreview ? RubberBand::RubberBandStretcher::Option::OptionEngineFaster : RubberBand::RubberBandStretcher::Option::OptionEngineFiner;
+    stretcher = std::make_shared<RubberBand::RubberBandStretcher>(static_cast<size_t>(settings.sampleRate), static_cast<size_t>(originalAudioSampleBuffer.getNumChannels()), RubberBand::RubberBandStretcher::OptionProcessOffline + RubberBand::RubberBandStretcher::Option::OptionPitchHighConsistency + engine);
+}
+
+RepitchingSingleInstrumentSampleProcessor::RepitchingSingleInstrumentSampleProcessor(std::string filePath, int rootMidiNote, const RenderSettings& settings, std::vector<Note> notes) : RepitchingSingleInstrumentSampleProcessor(filePath, rootMidiNote, settings) {
     for (auto note : notes) {
         getAudioForNoteNumber(note.midiNoteNumber);
     }
@@ -52,20 +43,65 @@ RepitchingSingleInstrumentSampleProcessor::RepitchingSingleInstrumentSampleProce
 
 
 juce::AudioBuffer<float> RepitchingSingleInstrumentSampleProcessor::getAudioForNoteNumber(int noteNumber) {
-    // check if the note exists in the map
+    // check if the note is cached
     
-    // if it does, return the buffer
-    // if it doesn't, process the audio and add it to the map
+    // if it is, return the buffer
+    // if it isn't, process the audio and cache it
+    if (compactStorage) {
+        return getCompactAudioForNoteNumber(noteNumber)->toFloat();
+    }
     
-    auto it = reprocessedAudioSampleBuffers.find(noteNumber);
+    return *getSharedAudioForNoteNumber(noteNumber);
+}
 
-    if (it != reprocessedAudioSampleBuffers.end()) {
-        return reprocessedAudioSampleBuffers[noteNumber];
+std::shared_ptr<const juce::AudioBuffer<float>> RepitchingSingleInstrumentSampleProcessor::getSharedAudioForNoteNumber(int noteNumber) {
+    if (compactStorage) {
+        return nullptr;
+    }
+    
+    const juce::ScopedLock scopedLock(lock);
+    
+    auto cached = cache.find(noteNumber);
+    if (cached.audio != nullptr) {
+        return cached.audio;
     }
     
+    auto output = std::make_shared<const juce::AudioBuffer<float>>(repitch(noteNumber));
+    cache.store(noteNumber, {output, nullptr});
+    return output;
+}
+
+RepitchCacheStats RepitchingSingleInstrumentSampleProcessor::getCacheStats() const {
+    const juce::ScopedLock scopedLock(lock);
+    return cache.getStats();
+}
+
+std::shared_ptr<const CompactAudioBuffer> RepitchingSingleInstrumentSampleProcessor::getCompactAudioForNoteNumber(int noteNumber) {
+    if (!compactStorage) {
+        return nullptr;
+    }
+    
+    const juce::ScopedLock scopedLock(lock);
+    
+    auto cached = cache.find(noteNumber);
+    if (cached.compact != nullptr) {
+        return cached.compact;
+    }
+    
+    auto compact = std::make_shared<const CompactAudioBuffer>(repitch(noteNumber));
+    cache.store(noteNumber, {nullptr, compact});
+    return compact;
+}
+
+// the caller holds the lock, the stretcher is shared between notes
+juce::AudioBuffer<float> RepitchingSingleInstrumentSampleProcessor::repitch(int noteNumber) {
     // process the audio
+    AllocationTracker::StageScope stage(AllocationStage::Repitch);
     
-    juce::AudioBuffer<float> copy(originalAudioSampleBuffer.getNumChannels(), originalAudioSampleBuffer.getNumSamples());
+    // the scratch buffers are pooled, a long running process repitches with buffers earlier notes left behind
+    auto& pool = AudioBufferPool::get();
+    auto pooledCopy = pool.acquire(originalAudioSampleBuffer.getNumChannels(), originalAudioSampleBuffer.getNumSamples());
+    auto& copy = *pooledCopy;
     for (int i = 0; i < originalAudioSampleBuffer.getNumChannels(); ++i) {
         copy.copyFrom(i, 0, originalAudioSampleBuffer, i, 0, originalAudioSampleBuffer.getNumSamples());
     }
@@ -85,7 +121,7 @@ juce::AudioBuffer<float> RepitchingSingleInstrumentSampleProcessor::getAudioForN
     while (true) {
         int chunkSize = stretcher->getSamplesRequired();
         int actualSend = std::min(chunkSize, originalAudioSampleBuffer.getNumSamples() - samplesSent);
-        copy.setSize(originalAudioSampleBuffer.getNumChannels(), actualSend, false, true, false);
+        copy.setSize(originalAudioSampleBuffer.getNumChannels(), actualSend, false, false, true);
         for (int channel = 0; channel < originalAudioSampleBuffer.getNumChannels(); ++channel) {
             copy.copyFrom(channel, 0, originalAudioSampleBuffer, channel, samplesSent, actualSend);
         }
@@ -100,7 +136,8 @@ juce::AudioBuffer<float> RepitchingSingleInstrumentSampleProcessor::getAudioForN
         
         while (stretcher->available() > 0) {
             int available = stretcher->available();
-            juce::AudioBuffer<float> processedBuffer(originalAudioSampleBuffer.getNumChannels(), available);
+            auto pooledProcessed = pool.acquire(originalAudioSampleBuffer.getNumChannels(), available);
+            auto& processedBuffer = *pooledProcessed;
             stretcher->retrieve(processedBuffer.getArrayOfWritePointers(), available);
             
             for (int i = 0; i < processedBuffer.getNumChannels(); ++i) {
@@ -121,7 +158,5 @@ juce::AudioBuffer<float> RepitchingSingleInstrumentSampleProcessor::getAudioForN
         output.copyFrom(channel, 0, processedSamples[channel].data(), processed);
     }
     
-    reprocessedAudioSampleBuffers[noteNumber] = output;
-    
     return output;
 }
@@ -16,25 +16,39 @@
 #include <fmt/core.h>
 #include "Note.h"
 #include "SampleProcessor.h"
+#include "RenderSettings.h"
+#include "RepitchCache.h"
 
 class RepitchingSingleInstrumentSampleProcessor : public SampleProcessor {
 public:
     
-    RepitchingSingleInstrumentSampleProcessor(std::string filePath, int rootMidiNote);
-    RepitchingSingleInstrumentSampleProcessor(std::string filePath, int rootMidiNote, std::vector<Note> notes);
+    RepitchingSingleInstrumentSampleProcessor(std::string filePath, int rootMidiNote, const RenderSettings& settings);
+    RepitchingSingleInstrumentSampleProcessor(std::string filePath, int rootMidiNote, const RenderSettings& settings, std::vector<Note> notes);
+    // sample is already at the render sample rate, sampleIdentity changes whenever its audio does
+    RepitchingSingleInstrumentSampleProcessor(juce::AudioBuffer<float> sample, std::size_t sampleIdentity, int rootMidiNote, const RenderSettings& settings);
     
     juce::AudioBuffer<float> getAudioForNoteNumber(int noteNumber) override;
+    std::shared_ptr<const CompactAudioBuffer> getCompactAudioForNoteNumber(int noteNumber) override;
+    std::shared_ptr<const juce::AudioBuffer<float>> getSharedAudioForNoteNumber(int noteNumber) override;
+    std::size_t getIdentityHash() const override { return identity; }
+    RepitchCacheStats getCacheStats() const;
 private:
     // sample buffers
     juce::AudioBuffer<float> originalAudioSampleBuffer;
-    // the map of all of midi notes to its reprocessed audio buffer
-    std::map<int, juce::AudioBuffer<float>> reprocessedAudioSampleBuffers;
+    // reprocessed notes, float or compact with RenderSettings::compactSampleStorage, bounded by
+    // RenderSettings::repitchCacheBudgetBytes
+    RepitchCache<int> cache;
+    bool compactStorage;
     
     // midi
     int rootMidiNote;
+    std::size_t identity = 0;
     
     // processing variables
     std::shared_ptr<RubberBand::RubberBandStretcher> stretcher;
+    // mix graph sources can render at the same time, this covers the cache and the stretcher
+    mutable juce::CriticalSection lock;
     
+    juce::AudioBuffer<float> repitch(int noteNumber);
 };
 
@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+
+    SampleBank.cpp
+    Created: 19 Oct 2026 9:36:18am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "SampleBank.h"
+#include <fmt/core.h>
+#include "SampleLoader.h"
+
+static const char bankMagic[4] = {'G', 'M', 'S', 'B'};
+static const int headerBytes = 4 + 4 + 8 + 4;
+static const int indexEntryBytes = 4 + 4 + 4 + 4 + 8;
+
+static juce::int64 alignUp(juce::int64 value, int alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static juce::int64 channelStride(int numSamples, int alignment) {
+    return alignUp(static_cast<juce::int64>(numSamples) * (juce::int64)sizeof(float), alignment);
+}
+
+void SampleBank::bake(const juce::File& outputFile, double sampleRate, const std::vector<Instrument>& instruments) {
+    struct PendingEntry {
+        int instrument;
+        int midiNote;
+        juce::AudioBuffer<float> audio;
+    };
+
+    // do all of the decoding and repitching up front so the index can be written before the payload
+    std::vector<PendingEntry> pending;
+    for (const auto& instrument : instruments) {
+        for (auto noteNumber : instrument.noteNumbers) {
+            fmt::println("Baking instrument {} note {}", instrument.identifier, noteNumber);
+            pending.push_back({instrument.identifier, noteNumber, instrument.processor->getAudioForNoteNumber(noteNumber)});
+        }
+    }
+
+    outputFile.deleteFile();
+    juce::FileOutputStream stream(outputFile);
+    if (stream.failedToOpen()) {
+        throw std::runtime_error("Could not open " + outputFile.getFullPathName().toStdString() + " for writing");
+    }
+
+    stream.write(bankMagic, sizeof(bankMagic));
+    stream.writeInt(VERSION);
+    stream.writeDouble(sampleRate);
+    stream.writeInt(static_cast<int>(pending.size()));
+
+    juce::int64 offset = alignUp(headerBytes + indexEntryBytes * static_cast<juce::int64>(pending.size()), ALIGNMENT);
+    for (const auto& entry : pending) {
+        stream.writeInt(entry.instrument);
+        stream.writeInt(entry.midiNote);
+        stream.writeInt(entry.audio.getNumChannels());
+        stream.writeInt(entry.audio.getNumSamples());
+        stream.writeInt64(offset);
+        offset += channelStride(entry.audio.getNumSamples(), ALIGNMENT) * entry.audio.getNumChannels();
+    }
+
+    for (const auto& entry : pending) {
+        stream.writeRepeatedByte(0, static_cast<size_t>(alignUp(stream.getPosition(), ALIGNMENT) - stream.getPosition()));
+        const auto stride = channelStride(entry.audio.getNumSamples(), ALIGNMENT);
+        const auto channelBytes = static_cast<size_t>(entry.audio.getNumSamples()) * sizeof(float);
+        for (int channel = 0; channel < entry.audio.getNumChannels(); ++channel) {
+            stream.write(entry.audio.getReadPointer(channel), channelBytes);
+            stream.writeRepeatedByte(0, static_cast<size_t>(stride) - channelBytes);
+        }
+    }
+
+    stream.flush();
+    fmt::println("Baked {} samples into {}", pending.size(), outputFile.getFullPathName().toStdString());
+}
+
+SampleBank::SampleBank(const juce::File& bankFile) : mappedFile(std::make_unique<juce::MemoryMappedFile>(bankFile, juce::MemoryMappedFile::readOnly)) {
+    const auto fileName = bankFile.getFullPathName().toStdString();
+    identity = SampleLoader::getFileIdentity(fileName);
+    if (mappedFile->getData() == nullptr || mappedFile->getSize() < headerBytes) {
+        throw std::runtime_error("Could not map sample bank " + fileName);
+    }
+
+    juce::MemoryInputStream stream(mappedFile->getData(), mappedFile->getSize(), false);
+    char magic[4];
+    stream.read(magic, sizeof(magic));
+    if (std::memcmp(magic, bankMagic, sizeof(bankMagic)) != 0 || stream.readInt() != VERSION) {
+        throw std::runtime_error(fileName + " is not a sample bank this version can read");
+    }
+
+    sampleRate = stream.readDouble();
+    const int entryCount = stream.readInt();
+    if (entryCount < 0 || headerBytes + indexEntryBytes * static_cast<juce::int64>(entryCount) > static_cast<juce::int64>(mappedFile->getSize())) {
+        throw std::runtime_error(fileName + " is truncated or corrupt");
+    }
+
+    for (int i = 0; i < entryCount; ++i) {
+        const int instrument = stream.readInt();
+        const int midiNote = stream.readInt();
+        Entry entry;
+        entry.numChannels = stream.readInt();
+        entry.numSamples = stream.readInt();
+        entry.offset = stream.readInt64();
+
+        const auto end = entry.offset + channelStride(entry.numSamples, ALIGNMENT) * entry.numChannels;
+        if (entry.offset % ALIGNMENT != 0 || end > static_cast<juce::int64>(mappedFile->getSize())) {
+            throw std::runtime_error(fileName + " is truncated or corrupt");
+        }
+        entries[{instrument, midiNote}] = entry;
+    }
+}
+
+bool SampleBank::hasAudio(int instrument, int noteNumber) const {
+    return entries.find({instrument, noteNumber}) != entries.end();
+}
+
+juce::AudioBuffer<float> SampleBank::getAudio(int instrument, int noteNumber) const {
+    auto it = entries.find({instrument, noteNumber});
+    if (it == entries.end()) {
+        throw std::runtime_error("Note not found");
+    }
+
+    const auto& entry = it->second;
+    const auto stride = channelStride(entry.numSamples, ALIGNMENT);
+    const auto* base = static_cast<const char*>(mappedFile->getData()) + entry.offset;
+
+    // the mapping is read only, the const_cast is only there because AudioBuffer doesn't have a const view
+    std::vector<float*> channels;
+    for (int channel = 0; channel < entry.numChannels; ++channel) {
+        channels.push_back(const_cast<float*>(reinterpret_cast<const float*>(base + stride * channel)));
+    }
+
+    return juce::AudioBuffer<float>(channels.data(), entry.numChannels, entry.numSamples);
+}
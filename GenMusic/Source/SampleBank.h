@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    SampleBank.h
+    Created: 19 Oct 2026 9:36:18am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <map>
+#include <memory>
+#include <vector>
+#include "SampleProcessor.h"
+
+/*
+    A single indexed file holding every decoded and repitched sample a render needs, so startup is just an mmap.
+
+    Layout (little endian):
+        header  : "GMSB", uint32 version, double sampleRate, uint32 entryCount
+        index   : entryCount * { int32 instrument, int32 midiNote, uint32 numChannels, uint32 numSamples, uint64 offset }
+        payload : 32 bit float channel data, every channel starting on a 16 byte boundary
+ */
+class SampleBank {
+public:
+    struct Instrument {
+        int identifier;
+        std::shared_ptr<SampleProcessor> processor;
+        std::vector<int> noteNumbers;
+    };
+
+    // asks every instrument's processor for each of its notes and writes the results to a bank file
+    static void bake(const juce::File& outputFile, double sampleRate, const std::vector<Instrument>& instruments);
+
+    SampleBank(const juce::File& bankFile);
+
+    double getSampleRate() const { return sampleRate; }
+    std::size_t getIdentityHash() const { return identity; }
+    bool hasAudio(int instrument, int noteNumber) const;
+
+    // the returned buffer refers straight into the mapped file, it must not be written to or outlive the bank
+    juce::AudioBuffer<float> getAudio(int instrument, int noteNumber) const;
+
+private:
+    // 2 holds every note the generators can play, banks from before that miss the melody's low notes
+    static constexpr int VERSION = 2;
+    static constexpr int ALIGNMENT = 16;
+
+    struct Entry {
+        int numChannels;
+        int numSamples;
+        juce::int64 offset;
+    };
+
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    std::map<std::pair<int, int>, Entry> entries;
+    double sampleRate = 0.0;
+    std::size_t identity = 0;
+};
@@ -0,0 +1,199 @@
+/*
+  ==============================================================================
+
+    SampleLoader.cpp
+    Created: 19 Oct 2026 9:37:57am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "SampleLoader.h"
+#include <algorithm>
+#include <fmt/core.h>
+#include "Utilities.h"
+
+static juce::ThreadPool& getLoadPool() {
+    static juce::ThreadPool pool(juce::SystemStats::getNumCpus());
+    return pool;
+}
+
+SampleConditioning SampleConditioning::fromSettings(const RenderSettings& settings) {
+    SampleConditioning conditioning;
+    conditioning.normalise = settings.normaliseSamples;
+    return conditioning;
+}
+
+std::size_t SampleConditioning::getHash() const {
+    std::size_t hash = 0;
+    hashCombine(hash, removeDC);
+    hashCombine(hash, silenceThresholdDb);
+    hashCombine(hash, normalise);
+    hashCombine(hash, normalise ? normalisedPeakDb : 0.0f);
+    return hash;
+}
+
+juce::AudioBuffer<float> SampleLoader::load(const std::string& filePath, double sampleRate, const SampleConditioning& conditioning) {
+    juce::File file(filePath);
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+    if (reader.get() == nullptr) {
+        throw std::runtime_error("Could not read sample " + filePath);
+    }
+
+    juce::AudioBuffer<float> audioSampleBuffer((int)reader->numChannels, (int)reader->lengthInSamples);
+    reader->read(&audioSampleBuffer, 0, (int)reader->lengthInSamples, 0, true, true);
+    // before resampling, there's less of it once the silence is gone
+    condition(audioSampleBuffer, conditioning);
+
+    if (reader->sampleRate == sampleRate) {
+        return audioSampleBuffer;
+    }
+
+    logVerbose("Resampling {} from {} to {}", filePath, reader->sampleRate, sampleRate);
+    return resample(audioSampleBuffer, reader->sampleRate, sampleRate);
+}
+
+std::vector<juce::AudioBuffer<float>> SampleLoader::loadAll(const std::vector<std::string>& filePaths, double sampleRate, const SampleConditioning& conditioning) {
+    std::vector<juce::AudioBuffer<float>> samples(filePaths.size());
+    std::vector<std::exception_ptr> failures(filePaths.size());
+    if (filePaths.empty()) {
+        return samples;
+    }
+
+    std::atomic<size_t> remaining { filePaths.size() };
+    juce::WaitableEvent finished;
+    for (size_t i = 0; i < filePaths.size(); ++i) {
+        getLoadPool().addJob([&, i]() {
+            try {
+                samples[i] = load(filePaths[i], sampleRate, conditioning);
+            } catch (...) {
+                failures[i] = std::current_exception();
+            }
+            if (--remaining == 0) {
+                finished.signal();
+            }
+            return juce::ThreadPoolJob::jobHasFinished;
+        });
+    }
+    finished.wait();
+
+    for (const auto& failure : failures) {
+        if (failure != nullptr) {
+            std::rethrow_exception(failure);
+        }
+    }
+    return samples;
+}
+
+void SampleLoader::condition(juce::AudioBuffer<float>& buffer, const SampleConditioning& conditioning) {
+    const int numChannels = buffer.getNumChannels();
+    int numSamples = buffer.getNumSamples();
+    if (numSamples == 0) {
+        return;
+    }
+
+    if (conditioning.removeDC) {
+        // the median rather than the mean, a decaying low note doesn't average out to zero over the length of a sample
+        std::vector<float> sorted(static_cast<size_t>(numSamples));
+        for (int channel = 0; channel < numChannels; ++channel) {
+            auto* samples = buffer.getWritePointer(channel);
+            std::copy(samples, samples + numSamples, sorted.begin());
+            auto middle = sorted.begin() + numSamples / 2;
+            std::nth_element(sorted.begin(), middle, sorted.end());
+            juce::FloatVectorOperations::add(samples, -*middle, numSamples);
+        }
+    }
+
+    // the first and last samples any channel has above the threshold
+    const auto threshold = juce::Decibels::decibelsToGain(conditioning.silenceThresholdDb);
+    int first = numSamples;
+    int last = -1;
+    for (int channel = 0; channel < numChannels; ++channel) {
+        const auto* samples = buffer.getReadPointer(channel);
+        for (int i = 0; i < first; ++i) {
+            if (std::abs(samples[i]) > threshold) {
+                first = i;
+                break;
+            }
+        }
+        for (int i = numSamples - 1; i > last; --i) {
+            if (std::abs(samples[i]) > threshold) {
+                last = i;
+                break;
+            }
+        }
+    }
+    if (last < first) {
+        // nothing but silence, leave it for whoever plays it to find out
+        return;
+    }
+    if (first > 0 || last < numSamples - 1) {
+        numSamples = last - first + 1;
+        for (int channel = 0; channel < numChannels; ++channel) {
+            auto* samples = buffer.getWritePointer(channel);
+            std::memmove(samples, samples + first, static_cast<size_t>(numSamples) * sizeof(float));
+        }
+        buffer.setSize(numChannels, numSamples, true, false, true);
+    }
+
+    if (conditioning.normalise) {
+        const auto peak = buffer.getMagnitude(0, numSamples);
+        if (peak > 0.0f) {
+            buffer.applyGain(juce::Decibels::decibelsToGain(conditioning.normalisedPeakDb) / peak);
+        }
+    }
+}
+
+std::size_t SampleLoader::getSampleIdentity(const std::string& filePath, const SampleConditioning& conditioning) {
+    auto hash = getFileIdentity(filePath);
+    hashCombine(hash, conditioning.getHash());
+    return hash;
+}
+
+std::size_t SampleLoader::getFileIdentity(const std::string& filePath) {
+    juce::File file(filePath);
+    std::size_t hash = 0;
+    hashCombine(hash, filePath);
+    hashCombine(hash, file.getSize());
+    hashCombine(hash, file.getLastModificationTime().toMilliseconds());
+    return hash;
+}
+
+juce::AudioBuffer<float> SampleLoader::resample(const juce::AudioBuffer<float>& buffer, double sourceSampleRate, double targetSampleRate) {
+    const double speedRatio = sourceSampleRate / targetSampleRate;
+    const int numOutputSamples = static_cast<int>(std::ceil(buffer.getNumSamples() / speedRatio));
+
+    // The interpolator has no filter of its own, so going down in rate would fold everything above the new nyquist
+    // back into the sample. Low pass it first with a linear phase windowed sinc, long enough that the stopband starts
+    // below the new nyquist, and read past its delay so the sample stays aligned
+    const juce::AudioBuffer<float>* source = &buffer;
+    int sourceOffset = 0;
+    juce::AudioBuffer<float> filtered;
+    if (speedRatio > 1.0) {
+        const auto order = static_cast<size_t>(2 * std::ceil(32.0 * speedRatio));
+        auto coefficients = juce::dsp::FilterDesign<float>::designFIRLowpassWindowMethod(static_cast<float>(0.45 * targetSampleRate), sourceSampleRate, order, juce::dsp::WindowingFunction<float>::kaiser, 8.0f);
+        sourceOffset = static_cast<int>(order / 2);
+
+        // padded with silence so the tail of the sample comes out of the filter
+        filtered.setSize(buffer.getNumChannels(), buffer.getNumSamples() + sourceOffset);
+        filtered.clear();
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
+            filtered.copyFrom(channel, 0, buffer, channel, 0, buffer.getNumSamples());
+            juce::dsp::FIR::Filter<float> filter(coefficients);
+            juce::dsp::AudioBlock<float> block(filtered.getArrayOfWritePointers() + channel, 1, static_cast<size_t>(filtered.getNumSamples()));
+            filter.process(juce::dsp::ProcessContextReplacing<float>(block));
+        }
+        source = &filtered;
+    }
+
+    juce::AudioBuffer<float> output(buffer.getNumChannels(), numOutputSamples);
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
+        juce::LagrangeInterpolator interpolator;
+        interpolator.process(speedRatio, source->getReadPointer(channel, sourceOffset), output.getWritePointer(channel), numOutputSamples, buffer.getNumSamples(), 0);
+    }
+
+    return output;
+}
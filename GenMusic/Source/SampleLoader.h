@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    SampleLoader.h
+    Created: 19 Oct 2026 9:37:57am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <string>
+#include <vector>
+#include "RenderSettings.h"
+
+// the clean up load does between decoding a sample and resampling it
+struct SampleConditioning {
+    bool removeDC = true;
+    // leading and trailing audio quieter than this, relative to full scale, is cut off
+    float silenceThresholdDb = -60.0f;
+    // scales each sample so its peak sits at normalisedPeakDb
+    bool normalise = false;
+    float normalisedPeakDb = -1.0f;
+
+    static SampleConditioning fromSettings(const RenderSettings& settings);
+    std::size_t getHash() const;
+};
+
+class SampleLoader {
+public:
+    // decodes a sample, conditions it and resamples it to the rate it will be rendered at, throws if the file can't
+    // be read
+    static juce::AudioBuffer<float> load(const std::string& filePath, double sampleRate, const SampleConditioning& conditioning = {});
+    // every file decoded and conditioned at the same time on the loader's threads, in the order of filePaths. Throws
+    // the first file's failure once they've all finished
+    static std::vector<juce::AudioBuffer<float>> loadAll(const std::vector<std::string>& filePaths, double sampleRate, const SampleConditioning& conditioning = {});
+
+    // identifies the file's current contents by path, size and modification time
+    static std::size_t getFileIdentity(const std::string& filePath);
+    // the file's identity along with what loading it with conditioning does to it
+    static std::size_t getSampleIdentity(const std::string& filePath, const SampleConditioning& conditioning);
+
+    // removes dc, trims the silence off both ends and normalises, in place
+    static void condition(juce::AudioBuffer<float>& buffer, const SampleConditioning& conditioning);
+
+    static juce::AudioBuffer<float> resample(const juce::AudioBuffer<float>& buffer, double sourceSampleRate, double targetSampleRate);
+};
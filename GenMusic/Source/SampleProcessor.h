@@ -11,9 +11,18 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <memory>
+#include "CompactAudioBuffer.h"
 
 class SampleProcessor {
 public:
     virtual ~SampleProcessor() = default;
     virtual juce::AudioBuffer<float> getAudioForNoteNumber(int noteNumber) = 0;
+    // the processor's own compact copy of the note, shared instead of copied. nullptr from processors that keep their
+    // audio as float, callers fall back to getAudioForNoteNumber then
+    virtual std::shared_ptr<const CompactAudioBuffer> getCompactAudioForNoteNumber(int /*noteNumber*/) { return nullptr; }
+    // the same for a processor that keeps its notes as float, nullptr when it doesn't hold on to them
+    virtual std::shared_ptr<const juce::AudioBuffer<float>> getSharedAudioForNoteNumber(int /*noteNumber*/) { return nullptr; }
+    // changes whenever the audio this processor would produce changes (different files, rate or settings)
+    virtual std::size_t getIdentityHash() const = 0;
 };
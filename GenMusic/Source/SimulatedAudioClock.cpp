@@ -0,0 +1,42 @@
+/*
+  ==============================================================================
+
+    SimulatedAudioClock.cpp
+    Created: 19 Oct 2026 9:53:11am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "SimulatedAudioClock.h"
+
+SimulatedAudioClock::SimulatedAudioClock(juce::AudioIODeviceCallback& callback, double sampleRate, int blockSize, int numChannels) : juce::Thread("Simulated audio clock"), callback(callback), sampleRate(sampleRate), blockSize(blockSize), output(numChannels, blockSize) {
+}
+
+SimulatedAudioClock::~SimulatedAudioClock() {
+    stop();
+}
+
+void SimulatedAudioClock::start() {
+    startThread(juce::Thread::Priority::highest);
+}
+
+void SimulatedAudioClock::stop() {
+    stopThread(1000);
+}
+
+void SimulatedAudioClock::run() {
+    const double blockMs = blockSize * 1000.0 / sampleRate;
+    auto nextDeadline = juce::Time::getMillisecondCounterHiRes();
+    
+    while (!threadShouldExit()) {
+        output.clear();
+        callback.audioDeviceIOCallbackWithContext(nullptr, 0, output.getArrayOfWritePointers(), output.getNumChannels(), blockSize, {});
+        
+        nextDeadline += blockMs;
+        const auto remainingMs = nextDeadline - juce::Time::getMillisecondCounterHiRes();
+        if (remainingMs >= 1.0) {
+            wait(static_cast<int>(remainingMs));
+        }
+    }
+}
@@ -0,0 +1,34 @@
+/*
+  ==============================================================================
+
+    SimulatedAudioClock.h
+    Created: 19 Oct 2026 9:53:11am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*
+    Stands in for an audio device on hosts that don't have one. Calls the callback on its own thread with blocks of
+    output, paced by the wall clock the way a device would pace it. A callback that runs late isn't waited for, the
+    next one follows straight away, so overruns show up in the callback's own timings.
+ */
+class SimulatedAudioClock : private juce::Thread {
+public:
+    SimulatedAudioClock(juce::AudioIODeviceCallback& callback, double sampleRate, int blockSize, int numChannels = 2);
+    ~SimulatedAudioClock() override;
+    
+    void start();
+    void stop();
+    
+private:
+    void run() override;
+    
+    juce::AudioIODeviceCallback& callback;
+    double sampleRate;
+    int blockSize;
+    juce::AudioBuffer<float> output;
+};
@@ -10,6 +10,13 @@
 
 #include "Song.h"
 #include <fmt/core.h>
+#include <string_view>
+#include "AllocationTracker.h"
+#include "DSPKernels.h"
+#include "Utilities.h"
+#include "Voices.h"
+#include "MixGraph.h"
+#include "AudioBufferPool.h"
 
 Song::Song(double bpm, double sampleRate) : bpm(bpm), sampleRate(sampleRate), midiRenderer(bpm, sampleRate) {
     
@@ -30,20 +37,20 @@ void Song::renderToFile(const juce::File& outputFile, const juce::AudioBuffer<fl
     }
 }
 
-juce::AudioBuffer<float> Song::generateSong(std::vector<std::pair<int, std::pair<NoteGenerator*, juce::Synthesiser*>>> noteGenerators, std::map<int, AudioProcessingBus> busses, std::map<int, EffectProcessor*> effects) {
+void Song::generateSong(std::vector<std::pair<int, std::pair<NoteGenerator*, juce::Synthesiser*>>> noteGenerators, const BusRouting& routing, const MixConsumer& consumeMix, StemCache* stemCache, MasterBusProcessor* master, RenderedNoteCache* noteCache) {
     
     std::vector<std::pair<int, std::pair<juce::MidiMessageSequence*, juce::Synthesiser*>>> midiSequences;
     
     for (auto& noteGenerator : noteGenerators) {
         auto* seq = new juce::MidiMessageSequence(midiRenderer.toMidiSequence(noteGenerator.second.first->generate()));
-        fmt::println("Generated sequence with {} events", seq->getNumEvents());
+        logVerbose("Generated sequence with {} events", seq->getNumEvents());
         midiSequences.push_back(std::make_pair(noteGenerator.first, std::make_pair(seq, noteGenerator.second.second)));
     }
     
     double earliestStartTime = 0;
     double latestEndTime = 0;
     for (auto sequence : midiSequences) {
-        fmt::println("Processing sequence for bus {} ({})", sequence.first, sequence.second.first->getNumEvents());
+        logVerbose("Processing sequence for bus {} ({})", sequence.first, sequence.second.first->getNumEvents());
         for (int i = 0; i < sequence.second.first->getNumEvents(); ++i) {
             auto message = sequence.second.first->getEventPointer(i)->message;
             double timeStamp = message.getTimeStamp();
@@ -55,37 +62,132 @@ juce::AudioBuffer<float> Song::generateSong(std::vector<std::pair<int, std::pair
     
     double totalTimeSpanInSeconds = latestEndTime - earliestStartTime;
     
-    fmt::println("total time: {}", totalTimeSpanInSeconds);
+    logVerbose("total time: {}", totalTimeSpanInSeconds);
     
     int totalSamples = static_cast<int>(totalTimeSpanInSeconds * sampleRate + (sampleRate * 2));
     
     
-    juce::AudioBuffer<float> buffer;
-    buffer.setSize(2, totalSamples);
-    buffer.clear();
+    MixGraph graph(sampleRate);
+    const int masterNode = graph.addMaster(master);
+    // every generator plays LOOPS passes over the same BAR_COUNT bars, the sources only synthesise the first one
+    const double loopLengthInSamples = NoteGenerator::BAR_COUNT * NoteGenerator::BEATS_PER_BAR * (60.0 / bpm) * sampleRate;
+    // busses rendered this time, their stems go into the cache once the graph has run
+    std::vector<std::pair<int, std::size_t>> renderedBusses;
+    // the return only changes when a send or one of the stems behind it does
+    std::vector<std::pair<int, float>> sends;
+    std::size_t returnKey = routing.auxReturn != nullptr ? routing.auxReturn->getConfigurationHash() : 0;
     
-    for (auto& bus : busses) {
-        int key = bus.first;
+    for (auto& effect : routing.effects) {
+        int key = effect.first;
         std::vector<std::pair<juce::MidiMessageSequence*, juce::Synthesiser*>> midiSynthPairs;
         
         for (auto& sequence : midiSequences) {
             if (sequence.first != key) {
                 continue;
             }
-            fmt::println("Adding sequence for bus {} ({})", key,sequence.second.first->getNumEvents());
+            logVerbose("Adding sequence for bus {} ({})", key,sequence.second.first->getNumEvents());
             midiSynthPairs.push_back(std::make_pair(sequence.second.first, sequence.second.second));
         }
         
-        bus.second.render(midiSynthPairs, buffer, effects.at(key));
+        const auto stemKey = getStemKey(midiSynthPairs, effect.second, totalSamples);
+        const juce::AudioBuffer<float>* busStem = stemCache != nullptr ? stemCache->find(stemKey) : nullptr;
+        
+        int busNode;
+        if (busStem == nullptr) {
+            busNode = graph.addBus(effect.second);
+            // a synth playing several sequences is one source, a synth can't render on two threads at once
+            std::map<juce::Synthesiser*, std::vector<juce::MidiMessageSequence*>> sequencesBySynth;
+            for (auto& pair : midiSynthPairs) {
+                sequencesBySynth[pair.second].push_back(pair.first);
+            }
+            for (auto& synthSequences : sequencesBySynth) {
+                graph.connect(graph.addSource(synthSequences.first, synthSequences.second, loopLengthInSamples, NoteGenerator::LOOPS, noteCache), busNode);
+            }
+            renderedBusses.push_back(std::make_pair(busNode, stemKey));
+        } else {
+            logVerbose("Reusing cached stem for bus {}", key);
+            busNode = graph.addNode([busStem](juce::AudioBuffer<float>& buffer) {
+                for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
+                    buffer.copyFrom(channel, 0, *busStem, channel, 0, buffer.getNumSamples());
+                }
+            });
+        }
+        graph.connect(busNode, masterNode);
+        
+        if (routing.getSend(key) > 0.0f) {
+            sends.push_back(std::make_pair(busNode, routing.getSend(key)));
+            hashCombine(returnKey, stemKey);
+            hashCombine(returnKey, routing.getSend(key));
+        }
+    }
+    
+    if (!sends.empty()) {
+        const juce::AudioBuffer<float>* returnStem = stemCache != nullptr ? stemCache->find(returnKey) : nullptr;
+        int returnNode;
+        if (returnStem == nullptr) {
+            returnNode = graph.addBus(routing.auxReturn);
+            for (auto& send : sends) {
+                graph.connect(send.first, returnNode, send.second);
+            }
+            renderedBusses.push_back(std::make_pair(returnNode, returnKey));
+        } else {
+            logVerbose("Reusing cached stem for the aux return");
+            returnNode = graph.addNode([returnStem](juce::AudioBuffer<float>& buffer) {
+                for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
+                    buffer.copyFrom(channel, 0, *returnStem, channel, 0, buffer.getNumSamples());
+                }
+            });
+        }
+        graph.connect(returnNode, masterNode);
+    }
+    
+    graph.prepare(totalSamples);
+    graph.process();
+    
+    if (stemCache != nullptr) {
+        for (auto& rendered : renderedBusses) {
+            stemCache->store(rendered.second, graph.getOutput(rendered.first));
+        }
     }
     
     for (auto& sequence : midiSequences) {
         delete sequence.second.first;
     }
+    
+    // the graph's buffers go back to the pool for the next song, only the mix leaves
+    consumeMix(graph.getOutput(masterNode));
+}
 
+// hashes the generated notes, what each synth would play them with and the bus effect configuration
+std::size_t Song::getStemKey(const std::vector<std::pair<juce::MidiMessageSequence*, juce::Synthesiser*>>& midiSynthPairs, EffectProcessor* processor, int numSamples) const {
+    std::size_t hash = 0;
+    hashCombine(hash, bpm);
+    hashCombine(hash, sampleRate);
+    hashCombine(hash, numSamples);
     
+    for (const auto& pair : midiSynthPairs) {
+        const auto* sequence = pair.first;
+        for (int i = 0; i < sequence->getNumEvents(); ++i) {
+            const auto& message = sequence->getEventPointer(i)->message;
+            hashCombine(hash, message.getTimeStamp());
+            hashCombine(hash, std::string_view(reinterpret_cast<const char*>(message.getRawData()), static_cast<size_t>(message.getRawDataSize())));
+        }
+        
+        auto* synth = pair.second;
+        hashCombine(hash, synth->getNumVoices());
+        hashCombine(hash, synth->isNoteStealingEnabled());
+        for (int i = 0; i < synth->getNumVoices(); ++i) {
+            if (auto* voice = dynamic_cast<SampleVoice*>(synth->getVoice(i))) {
+                hashCombine(hash, voice->getIdentityHash());
+            } else {
+                // a voice we don't know how to describe only ever matches itself
+                hashCombine(hash, reinterpret_cast<std::uintptr_t>(synth->getVoice(i)));
+            }
+        }
+    }
     
-    return buffer;
+    hashCombine(hash, processor->getConfigurationHash());
+    return hash;
 }
 
 void Song::renderToMidiFile(const juce::File &outputFile, const juce::MidiMessageSequence &sequence) {
@@ -97,6 +199,152 @@ void Song::renderToMidiFile(const juce::File &outputFile, const juce::MidiMessag
     midiFile.writeTo(stream);
 }
 
+void Song::renderStreamToFile(const juce::File& outputFile, std::vector<std::pair<int, std::pair<NoteGenerator*, juce::Synthesiser*>>> noteGenerators, const BusRouting& routing, MasterBusProcessor* master, double totalBeats, double windowInBeats) {
+    if (windowInBeats <= 0.0) {
+        throw std::invalid_argument("windowInBeats must be positive");
+    }
+    
+    outputFile.deleteFile();
+    auto fileStream = std::make_unique<juce::FileOutputStream>(outputFile);
+    if (fileStream->failedToOpen()) {
+        throw std::runtime_error("Could not open " + outputFile.getFullPathName().toStdString() + " for writing");
+    }
+    juce::WavAudioFormat wavFormat;
+    std::unique_ptr<juce::AudioFormatWriter> writer(wavFormat.createWriterFor(fileStream.get(), sampleRate, 2, 32, {}, 0));
+    if (writer == nullptr) {
+        throw std::runtime_error("Could not create a wav writer for " + outputFile.getFullPathName().toStdString());
+    }
+    fileStream.release(); // the writer owns the stream now
+    
+    // a synth shared by several generators (the drums) has to be rendered once per window with all of their events
+    struct StreamedSynth {
+        int bus;
+        juce::Synthesiser* synth;
+        std::vector<NoteGenerator*> generators;
+        // events generated but not played yet, note offs that hang past the end of a window wait here
+        juce::MidiMessageSequence pending;
+    };
+    std::vector<StreamedSynth> streamedSynths;
+    for (auto& noteGenerator : noteGenerators) {
+        noteGenerator.second.first->resetStream();
+        auto it = std::find_if(streamedSynths.begin(), streamedSynths.end(), [&](const StreamedSynth& streamed) { return streamed.synth == noteGenerator.second.second; });
+        if (it == streamedSynths.end()) {
+            streamedSynths.push_back({noteGenerator.first, noteGenerator.second.second, {noteGenerator.second.first}, {}});
+        } else {
+            it->generators.push_back(noteGenerator.second.first);
+        }
+    }
+    
+    const double samplesPerBeat = (60.0 / bpm) * sampleRate;
+    // same two second tail generateSong leaves for the last notes to ring out
+    const auto endSample = static_cast<juce::int64>(totalBeats * samplesPerBeat + sampleRate * 2);
+    const int maxWindowSamples = static_cast<int>(std::ceil(windowInBeats * samplesPerBeat)) + 1;
+    
+    auto& pool = AudioBufferPool::get();
+    auto pooledMix = pool.acquire(2, maxWindowSamples);
+    auto pooledBus = pool.acquire(2, maxWindowSamples);
+    auto pooledReturn = pool.acquire(2, maxWindowSamples);
+    auto& mix = *pooledMix;
+    auto& busBuffer = *pooledBus;
+    auto& returnBuffer = *pooledReturn;
+    juce::MidiBuffer midiBuffer;
+    
+    // the master bus runs behind the mix, its first samples are only the limiter's lookahead filling up
+    int samplesToDrop = 0;
+    if (master != nullptr) {
+        master->reset();
+        samplesToDrop = master->getLatencyInSamples();
+    }
+    
+    for (double windowStart = 0.0; ; windowStart += windowInBeats) {
+        const auto firstSample = static_cast<juce::int64>(windowStart * samplesPerBeat);
+        if (firstSample >= endSample) {
+            break;
+        }
+        const auto lastSample = std::min(endSample, static_cast<juce::int64>((windowStart + windowInBeats) * samplesPerBeat));
+        const int numSamples = static_cast<int>(lastSample - firstSample);
+        
+        if (windowStart < totalBeats) {
+            AllocationTracker::StageScope stage(AllocationStage::Generate);
+            const double lengthInBeats = std::min(windowInBeats, totalBeats - windowStart);
+            for (auto& streamed : streamedSynths) {
+                for (auto* generator : streamed.generators) {
+                    streamed.pending.addSequence(midiRenderer.toMidiSequence(generator->generateWindow(windowStart, lengthInBeats)), 0);
+                }
+                streamed.pending.sort();
+            }
+        }
+        
+        mix.clear();
+        returnBuffer.clear();
+        for (auto& effect : routing.effects) {
+            busBuffer.clear();
+            juce::AudioBuffer<float> busWindow(busBuffer.getArrayOfWritePointers(), busBuffer.getNumChannels(), numSamples);
+            
+            for (auto& streamed : streamedSynths) {
+                if (streamed.bus != effect.first) {
+                    continue;
+                }
+                
+                midiBuffer.clear();
+                int consumed = 0;
+                while (consumed < streamed.pending.getNumEvents()) {
+                    const auto& message = streamed.pending.getEventPointer(consumed)->message;
+                    if (message.getTimeStamp() >= lastSample) {
+                        break;
+                    }
+                    midiBuffer.addEvent(message, static_cast<int>(std::max<juce::int64>(0, static_cast<juce::int64>(message.getTimeStamp()) - firstSample)));
+                    consumed++;
+                }
+                while (consumed-- > 0) {
+                    streamed.pending.deleteEvent(0, false);
+                }
+                
+                streamed.synth->renderNextBlock(busWindow, midiBuffer, 0, numSamples);
+            }
+            
+            AllocationTracker::StageScope stage(AllocationStage::Effects);
+            effect.second->process(busWindow);
+            const float send = routing.getSend(effect.first);
+            for (int channel = 0; channel < mix.getNumChannels(); ++channel) {
+                DSPKernels::get().addScaled(mix.getWritePointer(channel), busWindow.getReadPointer(channel), 1.0f, numSamples);
+                if (send > 0.0f) {
+                    DSPKernels::get().addScaled(returnBuffer.getWritePointer(channel), busWindow.getReadPointer(channel), send, numSamples);
+                }
+            }
+        }
+        
+        AllocationTracker::StageScope effectsStage(AllocationStage::Effects);
+        if (routing.auxReturn != nullptr) {
+            juce::AudioBuffer<float> returnWindow(returnBuffer.getArrayOfWritePointers(), returnBuffer.getNumChannels(), numSamples);
+            routing.auxReturn->process(returnWindow);
+            for (int channel = 0; channel < mix.getNumChannels(); ++channel) {
+                DSPKernels::get().addScaled(mix.getWritePointer(channel), returnWindow.getReadPointer(channel), 1.0f, numSamples);
+            }
+        }
+        
+        if (master != nullptr) {
+            master->process(mix, 0, numSamples);
+        }
+        const int dropped = std::min(samplesToDrop, numSamples);
+        samplesToDrop -= dropped;
+        AllocationTracker::StageScope writeStage(AllocationStage::Write);
+        writer->writeFromAudioSampleBuffer(mix, dropped, numSamples - dropped);
+        logVerbose("Streamed beats {} to {}", windowStart, windowStart + windowInBeats);
+    }
+    
+    // push silence through for whatever the master bus was still holding back
+    if (master != nullptr) {
+        for (int remaining = master->getLatencyInSamples(); remaining > 0; ) {
+            const int numSamples = std::min(remaining, mix.getNumSamples());
+            mix.clear();
+            master->process(mix, 0, numSamples);
+            writer->writeFromAudioSampleBuffer(mix, 0, numSamples);
+            remaining -= numSamples;
+        }
+    }
+}
+
 juce::MidiMessageSequence Song::generateMidi(std::vector<NoteGenerator *> noteGenerators) {
     std::vector<Note> allNotes;
     for (auto& generator : noteGenerators) {
@@ -1,22 +1,41 @@
 #pragma once
+#include <functional>
 #include <vector>
 #include <JuceHeader.h>
 #include "NoteGenerator.h"
-#include "AudioProcessingBus.h"
 #include "MIDIRenderer.h"
 #include "EffectProcessor.h"
+#include "BusRouting.h"
+#include "StemCache.h"
+#include "RenderedNoteCache.h"
+#include "MasterBusProcessor.h"
 
 class Song {
 public:
+    // handed the finished mix while it's still in the graph's buffer, it's only valid for the call
+    using MixConsumer = std::function<void(const juce::AudioBuffer<float>&)>;
+
     Song(double bpm, double sampleRate);
     void renderToFile(const juce::File& outputFile, const juce::AudioBuffer<float>& buffer);
     void renderToMidiFile(const juce::File &outputFile, const juce::MidiMessageSequence& sequence);
     
-    juce::AudioBuffer<float> generateSong(std::vector<std::pair<int, std::pair<NoteGenerator*, juce::Synthesiser*>>> noteGenerators, std::map<int, AudioProcessingBus> busses, std::map<int, EffectProcessor*> effects);
+    // Builds a MixGraph with a source per synth, a bus per effect, the aux return fed by the busses' sends and the
+    // master bus last, then runs it. Every bus and the return render into their own stem before being mixed, with a
+    // stemCache only the ones whose inputs changed are rendered again, with a noteCache the sources add in cached
+    // renders of the notes they repeat instead of synthesising every one. The mix goes to consumeMix before its buffer
+    // goes back to the pool, so whoever wants it somewhere else copies it once, straight to where it's going.
+    void generateSong(std::vector<std::pair<int, std::pair<NoteGenerator*, juce::Synthesiser*>>> noteGenerators, const BusRouting& routing, const MixConsumer& consumeMix, StemCache* stemCache = nullptr, MasterBusProcessor* master = nullptr, RenderedNoteCache* noteCache = nullptr);
     
     juce::MidiMessageSequence generateMidi(std::vector<NoteGenerator*> noteGenerators);
+    
+    // Renders totalBeats of the generators' streams straight to outputFile a window at a time. Synths and effects keep
+    // running from one window to the next and each window is written as soon as it's mixed, so memory and the cost of
+    // a window only depend on windowInBeats, not on how long the stream is. master can be nullptr to write the raw mix.
+    void renderStreamToFile(const juce::File& outputFile, std::vector<std::pair<int, std::pair<NoteGenerator*, juce::Synthesiser*>>> noteGenerators, const BusRouting& routing, MasterBusProcessor* master, double totalBeats, double windowInBeats = NoteGenerator::PHRASE_LENGTH_IN_BEATS);
 
 private:
+    std::size_t getStemKey(const std::vector<std::pair<juce::MidiMessageSequence*, juce::Synthesiser*>>& midiSynthPairs, EffectProcessor* processor, int numSamples) const;
+    
     double bpm;
     double sampleRate;
     MIDIRenderer midiRenderer;
@@ -0,0 +1,48 @@
+/*
+  ==============================================================================
+
+    StemCache.cpp
+    Created: 19 Oct 2026 9:41:48am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "StemCache.h"
+
+
+StemCache::StemCache(size_t maxStems) : maxStems(maxStems) {
+
+}
+
+const juce::AudioBuffer<float>* StemCache::find(std::size_t key) {
+    auto it = stems.find(key);
+    if (it == stems.end()) {
+        misses++;
+        return nullptr;
+    }
+
+    hits++;
+    return &it->second;
+}
+
+void StemCache::store(std::size_t key, const juce::AudioBuffer<float>& stem) {
+    if (maxStems == 0) {
+        return;
+    }
+
+    if (stems.find(key) == stems.end()) {
+        insertionOrder.push_back(key);
+    }
+    stems[key].makeCopyOf(stem);
+
+    while (insertionOrder.size() > maxStems) {
+        stems.erase(insertionOrder.front());
+        insertionOrder.pop_front();
+    }
+}
+
+void StemCache::clear() {
+    stems.clear();
+    insertionOrder.clear();
+}
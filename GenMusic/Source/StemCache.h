@@ -0,0 +1,40 @@
+/*
+  ==============================================================================
+
+    StemCache.h
+    Created: 19 Oct 2026 9:41:48am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <deque>
+#include <map>
+
+/*
+    Finished, effected bus renders keyed by everything that went into them (the notes, the synth and sample
+    identity and the effect configuration). A re-render only recomputes the busses whose key changed.
+ */
+class StemCache {
+public:
+    StemCache(size_t maxStems = 8);
+
+    // nullptr when there's no stem for the key
+    const juce::AudioBuffer<float>* find(std::size_t key);
+    void store(std::size_t key, const juce::AudioBuffer<float>& stem);
+    void clear();
+
+    int getHits() const { return hits; }
+    int getMisses() const { return misses; }
+
+private:
+    size_t maxStems;
+    std::map<std::size_t, juce::AudioBuffer<float>> stems;
+    // oldest first, whole song stems are big so only the most recent few are kept
+    std::deque<std::size_t> insertionOrder;
+
+    int hits = 0;
+    int misses = 0;
+};
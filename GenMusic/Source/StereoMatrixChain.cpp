@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    StereoMatrixChain.cpp
+    Created: 19 Oct 2026 10:37:23am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "StereoMatrixChain.h"
+#include "DSPKernels.h"
+#include "Utilities.h"
+
+StereoMatrixChain::Matrix StereoMatrixChain::Matrix::then(const Matrix& next) const {
+    return {
+        next.leftFromLeft * leftFromLeft + next.leftFromRight * rightFromLeft,
+        next.leftFromLeft * leftFromRight + next.leftFromRight * rightFromRight,
+        next.rightFromLeft * leftFromLeft + next.rightFromRight * rightFromLeft,
+        next.rightFromLeft * leftFromRight + next.rightFromRight * rightFromRight,
+    };
+}
+
+StereoMatrixChain& StereoMatrixChain::add(const Matrix& stage) {
+    matrix = matrix.then(stage);
+    return *this;
+}
+
+StereoMatrixChain& StereoMatrixChain::gain(float linear) {
+    return add({linear, 0.0f, 0.0f, linear});
+}
+
+StereoMatrixChain& StereoMatrixChain::trim(float decibels) {
+    return gain(juce::Decibels::decibelsToGain(decibels, -1000.0f));
+}
+
+StereoMatrixChain& StereoMatrixChain::pan(float position) {
+    const auto clamped = juce::jlimit(-1.0f, 1.0f, position);
+    return add({std::min(1.0f, 1.0f - clamped), 0.0f, 0.0f, std::min(1.0f, 1.0f + clamped)});
+}
+
+StereoMatrixChain& StereoMatrixChain::invertPolarity(bool left, bool right) {
+    return add({left ? -1.0f : 1.0f, 0.0f, 0.0f, right ? -1.0f : 1.0f});
+}
+
+StereoMatrixChain& StereoMatrixChain::width(float width) {
+    // mid = (left + right) / 2 and side = (left - right) / 2, left out = mid * (1 + width) - side * width and right
+    // out = mid * (1 + width) + side * width, multiplied out
+    const auto same = 0.5f;
+    const auto cross = 0.5f + width;
+    return add({same, cross, cross, same});
+}
+
+bool StereoMatrixChain::isIdentity() const {
+    return matrix.leftFromLeft == 1.0f && matrix.leftFromRight == 0.0f && matrix.rightFromLeft == 0.0f && matrix.rightFromRight == 1.0f;
+}
+
+std::size_t StereoMatrixChain::getConfigurationHash() const {
+    // the same output from a different list of stages is the same configuration
+    std::size_t hash = typeid(StereoMatrixChain).hash_code();
+    hashCombine(hash, matrix.leftFromLeft);
+    hashCombine(hash, matrix.leftFromRight);
+    hashCombine(hash, matrix.rightFromLeft);
+    hashCombine(hash, matrix.rightFromRight);
+    return hash;
+}
+
+void StereoMatrixChain::process(juce::AudioBuffer<float>& buffer) const {
+    if (isIdentity()) {
+        return;
+    }
+    if (buffer.getNumChannels() == 1) {
+        buffer.applyGain(matrix.leftFromLeft + matrix.leftFromRight);
+        return;
+    }
+    jassert(buffer.getNumChannels() == 2);
+    process(buffer.getWritePointer(0), buffer.getWritePointer(1), buffer.getNumSamples());
+}
+
+void StereoMatrixChain::process(float* left, float* right, int numSamples) const {
+    DSPKernels::get().stereoMatrix(left, right, matrix.leftFromLeft, matrix.leftFromRight, matrix.rightFromLeft, matrix.rightFromRight, numSamples);
+}
@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    StereoMatrixChain.h
+    Created: 19 Oct 2026 10:37:23am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*
+    Gain, trim, pan, polarity and width only ever mix the left and right sample at the same instant with fixed
+    weights, each one is a 2x2 matrix on the pair. So a run of them multiplies down to one matrix as the stages are
+    added, and processing the run is a single pass over the block however many stages it has instead of one pass per
+    stage. Only stages like that belong here, anything with state (filters, dynamics, delays) ends the run and goes
+    before or after it in the effect processor.
+ */
+class StereoMatrixChain {
+public:
+    // left out = left * leftFromLeft + right * leftFromRight, right out the same with its own pair
+    struct Matrix {
+        float leftFromLeft = 1.0f;
+        float leftFromRight = 0.0f;
+        float rightFromLeft = 0.0f;
+        float rightFromRight = 1.0f;
+
+        // this then next, as one matrix
+        Matrix then(const Matrix& next) const;
+    };
+
+    StereoMatrixChain& gain(float linear);
+    StereoMatrixChain& trim(float decibels);
+    // -1 is hard left and 1 hard right, the far side is turned down and the near side left alone
+    StereoMatrixChain& pan(float position);
+    StereoMatrixChain& invertPolarity(bool left, bool right);
+    // mid scaled by 1 + width and side by width, 0 folds it down to mono
+    StereoMatrixChain& width(float width);
+
+    const Matrix& getMatrix() const { return matrix; }
+    bool isIdentity() const;
+    std::size_t getConfigurationHash() const;
+
+    // in place, a mono buffer is treated as the same signal on both sides and gets the left output
+    void process(juce::AudioBuffer<float>& buffer) const;
+    void process(float* left, float* right, int numSamples) const;
+
+private:
+    StereoMatrixChain& add(const Matrix& stage);
+
+    Matrix matrix;
+};
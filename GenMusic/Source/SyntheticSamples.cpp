@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    SyntheticSamples.cpp
+    Created: 19 Oct 2026 10:18:41am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#include "SyntheticSamples.h"
+
+const double TONE_SECONDS = 3.0;
+const double KICK_SECONDS = 0.5;
+const double HIT_SECONDS = 0.15;
+const double IMPULSE_RESPONSE_SECONDS = 2.5;
+// time for the tail to fall 60dB
+const double REVERB_TIME_SECONDS = 1.8;
+const int TONE_HARMONICS = 6;
+
+juce::AudioBuffer<float> SyntheticSamples::tone(double sampleRate, int rootMidiNote) {
+    juce::AudioBuffer<float> buffer(2, static_cast<int>(TONE_SECONDS * sampleRate));
+    const auto frequency = juce::MidiMessage::getMidiNoteInHertz(rootMidiNote);
+    const auto attackSamples = 0.005 * sampleRate;
+
+    auto* left = buffer.getWritePointer(0);
+    for (int i = 0; i < buffer.getNumSamples(); ++i) {
+        const auto time = i / sampleRate;
+        double sample = 0.0;
+        for (int harmonic = 1; harmonic <= TONE_HARMONICS; ++harmonic) {
+            if (frequency * harmonic >= sampleRate / 2) {
+                break;
+            }
+            // higher harmonics die away faster, like a struck string
+            const auto decay = std::exp(-time * (1.2 + 0.6 * harmonic));
+            sample += decay / harmonic * std::sin(juce::MathConstants<double>::twoPi * frequency * harmonic * time);
+        }
+        left[i] = static_cast<float>(0.4 * sample * std::min(1.0, i / attackSamples));
+    }
+    buffer.copyFrom(1, 0, buffer, 0, 0, buffer.getNumSamples());
+    return buffer;
+}
+
+juce::AudioBuffer<float> SyntheticSamples::kick(double sampleRate) {
+    juce::AudioBuffer<float> buffer(2, static_cast<int>(KICK_SECONDS * sampleRate));
+
+    auto* left = buffer.getWritePointer(0);
+    double phase = 0.0;
+    for (int i = 0; i < buffer.getNumSamples(); ++i) {
+        const auto time = i / sampleRate;
+        // the pitch drops from 150Hz to 45Hz in the first few tens of milliseconds
+        const auto frequency = 45.0 + 105.0 * std::exp(-time * 35.0);
+        phase += juce::MathConstants<double>::twoPi * frequency / sampleRate;
+        left[i] = static_cast<float>(0.9 * std::exp(-time * 8.0) * std::sin(phase));
+    }
+    buffer.copyFrom(1, 0, buffer, 0, 0, buffer.getNumSamples());
+    return buffer;
+}
+
+juce::AudioBuffer<float> SyntheticSamples::hit(double sampleRate) {
+    juce::AudioBuffer<float> buffer(2, static_cast<int>(HIT_SECONDS * sampleRate));
+    // fixed seed, the burst has to be the same every time for the stem cache
+    juce::Random random(0x5eed);
+
+    auto* left = buffer.getWritePointer(0);
+    float previous = 0.0f;
+    for (int i = 0; i < buffer.getNumSamples(); ++i) {
+        const auto time = i / sampleRate;
+        const auto noise = random.nextFloat() * 2.0f - 1.0f;
+        // a first difference tilts the noise up towards a stick click
+        left[i] = static_cast<float>(0.5 * std::exp(-time * 40.0)) * (noise - previous);
+        previous = noise;
+    }
+    buffer.copyFrom(1, 0, buffer, 0, 0, buffer.getNumSamples());
+    return buffer;
+}
+
+juce::AudioBuffer<float> SyntheticSamples::impulseResponse(double sampleRate) {
+    juce::AudioBuffer<float> buffer(2, static_cast<int>(IMPULSE_RESPONSE_SECONDS * sampleRate));
+    buffer.clear();
+    juce::Random random(0x7e7b);
+    // 60dB is a factor of 1000
+    const auto decayRate = std::log(1000.0) / REVERB_TIME_SECONDS;
+    // the first reflections take a few milliseconds to arrive and the tail takes a little longer to build
+    const auto preDelaySamples = static_cast<int>(0.01 * sampleRate);
+    const auto buildSamples = 0.03 * sampleRate;
+
+    for (int channel = 0; channel < 2; ++channel) {
+        auto* samples = buffer.getWritePointer(channel);
+        for (int i = preDelaySamples; i < buffer.getNumSamples(); ++i) {
+            const auto time = (i - preDelaySamples) / sampleRate;
+            const auto envelope = std::exp(-time * decayRate) * std::min(1.0, (i - preDelaySamples) / buildSamples);
+            samples[i] = static_cast<float>(envelope) * (random.nextFloat() * 2.0f - 1.0f);
+        }
+    }
+    return buffer;
+}
@@ -0,0 +1,28 @@
+/*
+  ==============================================================================
+
+    SyntheticSamples.h
+    Created: 19 Oct 2026 10:18:41am
+    Author:  Benjamin Conn
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+// Stand-ins for the sample files, generated at the render sample rate. They're about as long and as dense as the real
+// sounds so repitching and rendering them costs about the same, and the same rate always gives the same audio.
+class SyntheticSamples {
+public:
+    // a decaying piano-ish tone pitched at rootMidiNote
+    static juce::AudioBuffer<float> tone(double sampleRate, int rootMidiNote);
+    static juce::AudioBuffer<float> kick(double sampleRate);
+    // a short noise burst for the perc lane
+    static juce::AudioBuffer<float> hit(double sampleRate);
+    // a few seconds of decaying noise, different on each side, for the convolution reverb
+    static juce::AudioBuffer<float> impulseResponse(double sampleRate);
+
+    // stands in for the file identity in the processors' hashes, bump it whenever the generated audio changes
+    static constexpr std::size_t VERSION = 1;
+};
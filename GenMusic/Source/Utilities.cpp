@@ -10,6 +10,8 @@
 
 #include "Utilities.h"
 
+std::atomic<bool> verboseLogging { true };
+thread_local bool loggingMuted = false;
 
 std::vector<unsigned char> generateRandomBytes(size_t length, const std::string& seedString) {
     std::vector<unsigned char> bytes(length);
@@ -9,14 +9,36 @@
 */
 
 #pragma once
+#include <atomic>
 #include <random>
 #include <vector>
 #include <functional>
 #include <iostream>
 #include <vector>
+#include <string>
+#include <fmt/core.h>
 
 extern std::vector<unsigned char> generateRandomBytes(size_t length, const std::string& seedString);
 
+// boost style hash mixing, for building cache keys out of several values
+template <typename T>
+inline void hashCombine(std::size_t& seed, const T& value) {
+    seed ^= std::hash<T>{}(value) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+}
+
+// progress output from the render, turned off when stdout is needed for something else like the daemon protocol.
+// Shared by every engine in the process, so it's set once at startup rather than per render
+extern std::atomic<bool> verboseLogging;
+// set on a thread that mustn't print whatever verboseLogging says, like an audio callback's
+extern thread_local bool loggingMuted;
+
+template <typename... Args>
+inline void logVerbose(fmt::format_string<Args...> format, Args&&... args) {
+    if (!loggingMuted && verboseLogging.load(std::memory_order_relaxed)) {
+        fmt::println(format, std::forward<Args>(args)...);
+    }
+}
+
 template <typename T>
 inline T selectWeightedRandom(const std::vector<std::pair<T, int>>& items, int randomNumber) {
     int totalWeight = 0;
@@ -24,6 +46,11 @@ inline T selectWeightedRandom(const std::vector<std::pair<T, int>>& items, int r
         totalWeight += item.second;
     }
 
+    // everything can be compensated down to nothing over a long stream, treat the options as equally likely then
+    if (totalWeight <= 0) {
+        return items.at(randomNumber % items.size()).first;
+    }
+
     // Truncate the random number if it's out of range
     randomNumber = randomNumber % totalWeight;
 
@@ -13,6 +13,10 @@
 #include <rubberband/RubberBandStretcher.h>
 #include <fmt/core.h>
 #include "SampleProcessor.h"
+#include "PreparedSampleTable.h"
+#include "Utilities.h"
+#include "AllocationTracker.h"
+#include "DSPKernels.h"
 
 const int CHUNK_SIZE = 1024;
 
@@ -23,32 +27,70 @@ public:
 };
 
 
-// TODO take in more than one sample and find the nearest sample for any given note to pull from
 // TODO drum sample voice with no envelope 
 class SampleVoice : public juce::SynthesiserVoice {
 public:
-    SampleVoice(std::shared_ptr<SampleProcessor> samples, int identifier, float startGain = 0.8f): identifier(identifier), sampleProcessor(samples) {
-        envelope.setSampleRate(44100);
-        setCurrentPlaybackSampleRate(44100);
-        gain.setGainLinear(startGain);
+    // the sample rate comes from the synthesiser, it hands its own rate to every voice it's given
+    SampleVoice(std::shared_ptr<SampleProcessor> samples, int identifier, float startGain = 0.8f): identifier(identifier), gain(startGain), appliedGain(startGain), sampleProcessor(samples) {
         envelope.setParameters({0.2, 0.5, 0.8, 0.4});
+        reusableCopyBuffer.setSize(2, CHUNK_SIZE);
+        envelopeValues.resize(CHUNK_SIZE);
+    }
+    
+    void setCurrentPlaybackSampleRate(double newRate) override {
+        juce::SynthesiserVoice::setCurrentPlaybackSampleRate(newRate);
+        if (newRate > 0) {
+            envelope.setSampleRate(newRate);
+        }
     }
     bool canPlaySound(juce::SynthesiserSound* sound) override {
         auto result = dynamic_cast<DefaultSynthSound*>(sound) != nullptr;
         return result;
     }
     
+    // real time playback: notes only come out of the table and one it doesn't have is skipped, nullptr goes back to
+    // asking the processor (which may repitch) for every note
+    void setPreparedSamples(std::shared_ptr<const PreparedSampleTable> table) {
+        preparedSamples = table;
+    }
+    
     void startNote (int midiNoteNumber, float velocity, juce::SynthesiserSound* sound, int currentPitchWheelPosition) override {
         midiNote = midiNoteNumber;
-        audioSampleBuffer = sampleProcessor->getAudioForNoteNumber(midiNote);
+        playingAudio = nullptr;
+        playingCompactAudio = nullptr;
+        if (preparedSamples != nullptr) {
+            const auto* prepared = preparedSamples->find(midiNote);
+            if (prepared == nullptr) {
+                clearCurrentNote();
+                return;
+            }
+            playingAudio = &prepared->audio;
+            playingCompactAudio = prepared->compact.get();
+        } else {
+            AllocationTracker::StageScope stage(AllocationStage::VoiceStart);
+            // compact audio is shared with the processor rather than copied
+            compactAudio = sampleProcessor->getCompactAudioForNoteNumber(midiNote);
+            playingCompactAudio = compactAudio.get();
+            if (compactAudio == nullptr) {
+                // so is float audio the processor holds on to, only what it makes up on the spot is copied
+                sharedAudio = sampleProcessor->getSharedAudioForNoteNumber(midiNote);
+                if (sharedAudio != nullptr) {
+                    playingAudio = sharedAudio.get();
+                } else {
+                    audioSampleBuffer = sampleProcessor->getAudioForNoteNumber(midiNote);
+                    playingAudio = &audioSampleBuffer;
+                }
+            }
+        }
         audioSampleBufferIndex = 0;
         envelope.noteOn();
     }
     
     void stopNote(float velocity, bool allowTailOff) override {
-        if (envelope.isActive()) {
+        if (allowTailOff && envelope.isActive()) {
             envelope.noteOff(); // Start the release phase
         } else {
+            envelope.reset();
             clearCurrentNote(); // Immediate stop
         }
         
@@ -59,34 +101,50 @@ public:
             return;
         }
         
-        fmt::print("Rendering next block for voice {} {}\n", identifier, audioSampleBufferIndex);
+        logVerbose("Rendering next block for voice {} {}", identifier, audioSampleBufferIndex);
+        
+        // nothing below may allocate: the block is mixed CHUNK_SIZE samples at a time through the scratch buffer
+        // the constructor sized, so an offline render's huge blocks cost no more memory than a device's small ones
+        AllocationTracker::StageScope stage(AllocationStage::VoiceRender);
         
-        int processSize = std::min(numSamples, audioSampleBuffer.getNumSamples() - audioSampleBufferIndex);
-        if (processSize > 0) {
-            juce::AudioBuffer<float> copyBuffer;
-            copyBuffer.setSize(audioSampleBuffer.getNumChannels(), processSize, false, false, false);
+        const auto& kernels = DSPKernels::get();
+        const int numChannels = std::min(outputBuffer.getNumChannels(), playingCompactAudio != nullptr ? playingCompactAudio->getNumChannels() : playingAudio->getNumChannels());
+        const int audioLength = playingCompactAudio != nullptr ? playingCompactAudio->getNumSamples() : playingAudio->getNumSamples();
+        int processSize = std::min(numSamples, audioLength - audioSampleBufferIndex);
+        for (int offset = 0; offset < processSize; offset += CHUNK_SIZE) {
+            const int chunkSize = std::min(CHUNK_SIZE, processSize - offset);
             
-            for (int channel = 0; channel < audioSampleBuffer.getNumChannels(); ++channel) {
-                copyBuffer.copyFrom(channel, 0, audioSampleBuffer, channel, audioSampleBufferIndex, processSize);
+            // the envelope steps once per sample, so it and the gain are worked out once for the chunk and every
+            // channel is then scaled and mixed in a single pass
+            for (int i = 0; i < chunkSize; ++i) {
+                envelopeValues[i] = envelope.getNextSample();
             }
+            kernels.applyGainRamp(envelopeValues.data(), appliedGain, gain, chunkSize);
+            appliedGain = gain;
             
-            juce::dsp::AudioBlock<float> audioBlock { copyBuffer };
-            gain.process(juce::dsp::ProcessContextReplacing<float> (audioBlock));
-            envelope.applyEnvelopeToBuffer(copyBuffer, 0, copyBuffer.getNumSamples());
-            
-            for (int channel = 0; channel < copyBuffer.getNumChannels(); ++channel) {
-                outputBuffer.addFrom(channel, startSample, copyBuffer, channel, 0, processSize);
+            for (int channel = 0; channel < numChannels; ++channel) {
+                const float* source;
+                if (playingCompactAudio != nullptr) {
+                    // compact audio is widened back to float here, one chunk at a time
+                    playingCompactAudio->read(channel, audioSampleBufferIndex, reusableCopyBuffer.getWritePointer(channel), chunkSize);
+                    source = reusableCopyBuffer.getReadPointer(channel);
+                } else {
+                    source = playingAudio->getReadPointer(channel, audioSampleBufferIndex);
+                }
+                kernels.multiplyAdd(outputBuffer.getWritePointer(channel, startSample + offset), source, envelopeValues.data(), chunkSize);
             }
             
-            audioSampleBufferIndex += processSize;
+            audioSampleBufferIndex += chunkSize;
         }
 
         if (!envelope.isActive()) {
             clearCurrentNote();
         }
 
-        if (audioSampleBufferIndex >= audioSampleBuffer.getNumSamples()) {
-            stopNote(0.0f, true); // Automatically stop the note if we've reached the end of the sample
+        if (audioSampleBufferIndex >= audioLength) {
+            // Automatically stop the note if we've reached the end of the sample. There's nothing left for a release
+            // to fade, and one started here would never advance, the voice would stay busy until it was stolen
+            stopNote(0.0f, false);
         }
     }
     
@@ -98,14 +156,38 @@ public:
         // Handle other MIDI controllers if needed
     }
     
+    // ramped to over the next chunk rather than jumped to
     void setGain(float newGain) {
-        gain.setGainLinear(newGain);
+        gain = newGain;
+    }
+    
+    // how long a note keeps sounding after its note off, at most
+    double getReleaseSeconds() const {
+        return envelope.getParameters().release;
+    }
+    
+    // everything that decides what this voice sounds like for a given note
+    std::size_t getIdentityHash() const {
+        auto hash = sampleProcessor->getIdentityHash();
+        hashCombine(hash, gain);
+        const auto& parameters = envelope.getParameters();
+        for (auto value : {parameters.attack, parameters.decay, parameters.sustain, parameters.release}) {
+            hashCombine(hash, value);
+        }
+        return hash;
     }
     
 private:
-    // sample buffers
+    // sample buffers, playingAudio points at sharedAudio, audioSampleBuffer or into the prepared table and
+    // playingCompactAudio at compactAudio or into the table. The note plays from the compact one when it's set
     juce::AudioBuffer<float> audioSampleBuffer;
+    std::shared_ptr<const juce::AudioBuffer<float>> sharedAudio;
+    const juce::AudioBuffer<float>* playingAudio = nullptr;
+    std::shared_ptr<const CompactAudioBuffer> compactAudio;
+    const CompactAudioBuffer* playingCompactAudio = nullptr;
     juce::AudioBuffer<float> reusableCopyBuffer;
+    std::vector<float> envelopeValues;
+    std::shared_ptr<const PreparedSampleTable> preparedSamples;
     
     // midi
     int identifier;
@@ -115,7 +197,8 @@ private:
     int audioSampleBufferIndex = 0;
     
     // mix, envelope, effects
-    juce::dsp::Gain<float> gain;
+    float gain;
+    float appliedGain;
     juce::ADSR envelope;
     std::shared_ptr<SampleProcessor> sampleProcessor;
 };